@@ -4,272 +4,2729 @@
    ✔ Fixes final off-by-one bug to match Gantt chart exactly
 */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/wait.h>
 #include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/timerfd.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <limits.h>
+#include <math.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/inotify.h>
+#include <sys/un.h>
+#include <pthread.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "jobproto.h"
+#include "policy.h"
 
-typedef enum { NOT_STARTED, RUNNING, SUSPENDED, TERMINATED } state_t;
+/* Per-job results, indexed by job_t.idx; outlives the job_t itself */
+typedef struct {
+    int id;
+    int arrival;
+    int burst;
+    int completion;
+    int deadline;           /* -1 = none */
+    int user, group;
+    int crashed;
+    long contended;         /* ticks run while another user had jobs in too */
+    double policy_stat;     /* the policy's stat_name column */
+} job_stat_t;
+
+static job_t *input_head = NULL;
+static job_t *input_tail = NULL;    /* kept only while --online merges in */
+static int online_live = 0;         /* --online input has not ended yet */
+
+/* Gantt chart as run-length spans: consecutive ticks of the same job (or of
+   idle, id -1) share one entry, so long idle gaps cost a single record. */
+typedef struct {
+    int id;
+    int start;
+    int len;
+} gantt_span_t;
+
+typedef struct {
+    gantt_span_t *spans;
+    int count;
+    int cap;
+    int ticks;          /* total ticks recorded (same for every row) */
+} gantt_row_t;
+
+/* Idle spans at least this long (on every core) print as one collapsed cell */
+#define GANTT_IDLE_COLLAPSE 3
+
+/* One simulated core: its running job, its own instance of the scheduling
+   policy (which holds the runnable jobs) and its Gantt row. */
+typedef struct {
+    int id;
+    int core;           /* host CPU jobs on this slot are pinned to */
+    job_t *current;
+    void *rq;           /* policy state for this core */
+    int rq_len;         /* runnable jobs the policy holds */
+    gantt_row_t gantt;
+    long busy_ticks;
+    long dispatches;
+    long steals;
+} cpu_t;
+
+/* --cpus N: N cores, each with its own queue; 1 = classic single-CPU RR */
+static cpu_t *cpus = NULL;
+static int ncpus = 1;
+static int queued_jobs = 0;     /* sum of rq_len over all cores */
+static long preemptions = 0;    /* SIGTSTP/SIGCONT pairs (or freeze/thaw) */
+
+/* --policy NAME|path.so and its --policy-opt string */
+static const sched_policy_t *policy = &rr_policy;
+static const char *policy_opts = "";
+static void *policy_handle = NULL;
+
+static const sched_policy_t *builtin_policies[] = {
+    &rr_policy,
+    &mlfq_policy,
+    &cfs_policy,
+    &edf_policy,
+    &lottery_policy,
+    &stride_policy,
+    &drr_policy,
+    &sjf_policy,
+    &srtf_policy,
+    &fair_policy,
+    NULL
+};
+
+/* --simulate: virtual clock, no fork/signals/sleep.
+   --quiet: suppress the per-tick event trace, the Gantt chart and the
+   per-job statistics rows, all of which grow with the trace. */
+static int simulate = 0;
+static int quiet = 0;
+
+/* Tick engine: one tick lasts quantum_us / time_scale of wall-clock time.
+   Deadlines are absolute (tick_origin + t * tick_ns) so lateness in one
+   tick never carries over into the next. */
+static long quantum_us = 1000000;
+static double time_scale = 1.0;
+static int64_t tick_ns = 0;
+static struct timespec tick_origin;
+static int tick_fd = -1;
+
+#define TRACE(...) do { if (!quiet) printf(__VA_ARGS__); } while (0)
+
+/* ---------------- QUEUE FUNCTIONS ---------------- */
+/* Thin wrappers that keep the per-core and global queue counts in step
+   with what the policy holds. */
+
+void enqueue_new(cpu_t *c, job_t *j, int t) {
+    j->cpu = c->id;
+    j->policy_data = NULL;
+    policy->on_arrival(c->rq, j, t);
+    c->rq_len++;
+    queued_jobs++;
+}
+
+void enqueue_again(cpu_t *c, job_t *j, int t) {
+    j->cpu = c->id;
+    policy->on_preempt(c->rq, j, t);
+    c->rq_len++;
+    queued_jobs++;
+}
+
+job_t *dequeue_next(cpu_t *c, int t) {
+    job_t *j = policy->pick_next(c->rq, t);
+    if (j) {
+        c->rq_len--;
+        queued_jobs--;
+    }
+    return j;
+}
+
+/* Users (group, user) with jobs in the system, so the per-user table can
+   tell the ticks users competed for from those one user had to itself */
+typedef struct {
+    unsigned long long key;
+    int used;
+    int live;           /* this user's jobs between arrival and leaving */
+} user_live_t;
+
+static user_live_t *user_tab = NULL;
+static int user_cap = 0, user_n = 0;
+static int users_live = 0;      /* users with live > 0 */
+
+static user_live_t *user_find(const job_t *j) {
+    unsigned long long key = (unsigned long long)(unsigned int)j->group << 32 | (unsigned int)j->user;
+    if (2 * (user_n + 1) > user_cap) {
+        user_live_t *old = user_tab;
+        int old_cap = user_cap;
+        user_cap = user_cap ? user_cap * 2 : 64;
+        user_tab = calloc(user_cap, sizeof(user_live_t));
+        if (!user_tab) { perror("calloc"); exit(1); }
+        for (int i = 0; i < old_cap; i++) {
+            if (!old[i].used) continue;
+            size_t h = (old[i].key * 0x9E3779B97F4A7C15ull >> 32) & (user_cap - 1);
+            while (user_tab[h].used) h = (h + 1) & (user_cap - 1);
+            user_tab[h] = old[i];
+        }
+        free(old);
+    }
+    size_t h = (key * 0x9E3779B97F4A7C15ull >> 32) & (user_cap - 1);
+    while (user_tab[h].used && user_tab[h].key != key) h = (h + 1) & (user_cap - 1);
+    if (!user_tab[h].used) {
+        user_tab[h].used = 1;
+        user_tab[h].key = key;
+        user_n++;
+    }
+    return &user_tab[h];
+}
+
+void user_arrive(const job_t *j) {
+    if (user_find(j)->live++ == 0) users_live++;
+}
+
+void user_leave(const job_t *j) {
+    if (--user_find(j)->live == 0) users_live--;
+}
+
+/* The job leaves the system; unlink it first if it is still queued */
+void policy_forget(cpu_t *c, job_t *j, int t) {
+    int queued = j != c->current;
+    user_leave(j);
+    policy->on_finish(c->rq, j, queued, t);
+    if (queued) {
+        c->rq_len--;
+        queued_jobs--;
+    }
+}
+
+job_t *pop_input_if_arrival_le(int t) {
+    if (!input_head) return NULL;
+    if (input_head->arrival <= t) {
+        job_t *j = input_head;
+        input_head = input_head->next;
+        j->next = NULL;
+        return j;
+    }
+    return NULL;
+}
+
+/* Trace suffix naming the core, empty in single-CPU mode */
+const char *cpu_tag(int cpu) {
+    static char buf[32];
+    if (ncpus == 1) return "";
+    snprintf(buf, sizeof(buf), " on CPU%d", cpu);
+    return buf;
+}
+
+/* New arrivals go to the least loaded core (lowest index on ties) */
+void move_arrivals_to_rr(int t) {
+    job_t *m;
+    while ((m = pop_input_if_arrival_le(t)) != NULL) {
+        cpu_t *best = &cpus[0];
+        for (int i = 1; i < ncpus; i++) {
+            cpu_t *c = &cpus[i];
+            if (c->rq_len + (c->current != NULL) < best->rq_len + (best->current != NULL))
+                best = c;
+        }
+        TRACE("[t=%d] ➤ Job %d ARRIVED (burst=%d)%s\n", t, m->id, m->total_cpu, cpu_tag(best->id));
+        user_arrive(m);
+        enqueue_new(best, m, t);
+    }
+}
+
+/* An idle core with an empty queue takes a job from the longest queue
+   elsewhere; which one is the policy's call (RR: the tail, the job that
+   would wait longest there). Policies without a steal hook never share. */
+void steal_work(cpu_t *c, int t) {
+    if (!policy->steal) return;
+    cpu_t *victim = NULL;
+    for (int i = 0; i < ncpus; i++) {
+        if (&cpus[i] == c || cpus[i].rq_len == 0) continue;
+        if (!victim || cpus[i].rq_len > victim->rq_len) victim = &cpus[i];
+    }
+    if (!victim) return;
+    job_t *j = policy->steal(victim->rq);
+    if (!j) return;
+    victim->rq_len--;
+    queued_jobs--;
+    enqueue_again(c, j, t);
+    c->steals++;
+    TRACE("[t=%d] ⇄ CPU%d STOLE Job %d from CPU%d\n", t, c->id, j->id, victim->id);
+}
+
+int any_jobs_left() {
+    return (input_head != NULL) || (queued_jobs > 0) || online_live;
+}
+
+int any_cpu_busy() {
+    for (int i = 0; i < ncpus; i++)
+        if (cpus[i].current) return 1;
+    return 0;
+}
+
+void cpus_init() {
+    cpus = calloc(ncpus, sizeof(cpu_t));
+
+    /* Map slots onto the host CPUs we are allowed to run on */
+    cpu_set_t allowed;
+    int host[CPU_SETSIZE], nhost = 0;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+        for (int i = 0; i < CPU_SETSIZE; i++)
+            if (CPU_ISSET(i, &allowed)) host[nhost++] = i;
+
+    for (int i = 0; i < ncpus; i++) {
+        cpus[i].id = i;
+        cpus[i].core = nhost ? host[i % nhost] : i;
+        cpus[i].rq = policy->init(i, ncpus, policy_opts);
+        if (!cpus[i].rq) {
+            fprintf(stderr, "policy %s: init failed (opts \"%s\")\n", policy->name, policy_opts);
+            exit(1);
+        }
+    }
+    if (ncpus > nhost && nhost && !simulate)
+        fprintf(stderr, "warning: --cpus %d but only %d host CPUs available\n", ncpus, nhost);
+}
+
+/* --policy: a built-in name, or a path to a module exporting sched_policy */
+void policy_load(const char *spec) {
+    for (int i = 0; builtin_policies[i]; i++) {
+        if (strcmp(builtin_policies[i]->name, spec) == 0) {
+            policy = builtin_policies[i];
+            return;
+        }
+    }
+    if (!strchr(spec, '/') && !strstr(spec, ".so")) {
+        fprintf(stderr, "unknown policy '%s' (built-in:", spec);
+        for (int i = 0; builtin_policies[i]; i++) fprintf(stderr, " %s", builtin_policies[i]->name);
+        fprintf(stderr, ")\n");
+        exit(1);
+    }
+
+    policy_handle = dlopen(spec, RTLD_NOW | RTLD_LOCAL);
+    if (!policy_handle) { fprintf(stderr, "dlopen: %s\n", dlerror()); exit(1); }
+    const sched_policy_t *p = dlsym(policy_handle, "sched_policy");
+    if (!p) { fprintf(stderr, "dlsym: %s\n", dlerror()); exit(1); }
+    if (p->api != SCHED_POLICY_API || !p->init || !p->on_arrival || !p->pick_next ||
+        !p->on_tick || !p->on_preempt || !p->on_finish) {
+        fprintf(stderr, "%s: incompatible policy module (api %d, want %d)\n",
+                spec, p->api, SCHED_POLICY_API);
+        exit(1);
+    }
+    policy = p;
+}
+
+void policies_fini() {
+    for (int i = 0; i < ncpus; i++)
+        if (policy->fini) policy->fini(cpus[i].rq);
+    if (policy_handle) dlclose(policy_handle);
+}
+
+/* ---------------- GANTT RECORDING ---------------- */
+
+/* Record `n` consecutive ticks of job `id` (-1 = idle) on one core */
+void gantt_record(cpu_t *c, int id, int n) {
+    gantt_row_t *r = &c->gantt;
+    if (n <= 0) return;
+    r->ticks += n;
+    if (r->count > 0 && r->spans[r->count - 1].id == id) {
+        r->spans[r->count - 1].len += n;
+        return;
+    }
+    if (r->count == r->cap) {
+        r->cap = r->cap ? r->cap * 2 : 256;
+        r->spans = realloc(r->spans, r->cap * sizeof(gantt_span_t));
+        if (!r->spans) { perror("realloc"); exit(1); }
+    }
+    r->spans[r->count].id = id;
+    r->spans[r->count].start = r->ticks - n;
+    r->spans[r->count].len = n;
+    r->count++;
+}
+
+/* ---------------- CSV LOADING ---------------- */
+/* The trace is mapped (or, for pipes, read) whole. A 64-byte block at a
+   time is compared against ',' and '\n' with SSE2/AVX2; the resulting bit
+   masks give every field boundary without looking at bytes one by one.
+   Each field is then parsed with an 8-digits-at-once SWAR conversion.
+
+   Rows are read the way the old fgets+sscanf("%d,%d,...") loader read
+   them: '#' lines and near-empty lines are skipped, leading blanks and a
+   sign are accepted, and a row stops at the first field that is not a
+   number or is followed by anything but the next comma. A row with at
+   least 3 numbers is a job. The 8-column Stallings/HOST layout and its
+   optional extra columns fill in by position. A 3-column
+   `arrival,id,service` row keeps loading as it always did, with ids
+   numbered in load order.
+
+   Large traces are cut at line boundaries into one chunk per loader
+   thread (--load-threads). Each thread parses its chunk into its own
+   contiguous block of job records. Once every thread has its count, a
+   prefix sum gives each block its first id and the threads link their
+   blocks into one input list in file order. Ids, idx and list order are
+   the same as a sequential load. Job records live in these blocks until
+   exit; nothing frees them one by one. */
+
+#define CSV_MAX_FIELDS 13
+#define JOB_FIELDS (CSV_MAX_FIELDS + 1)    /* + processors, which only SWF has */
+#define CSV_MIN_CHUNK (1 << 20)     /* don't split below 1 MB a thread */
+
+static int load_threads = 0;        /* 0 = one per usable CPU, up to 16 */
+
+typedef struct {
+    const char *data;
+    size_t size, begin, end;        /* this chunk is [begin, end) */
+    job_t *jobs;                    /* the block */
+    int count, cap;
+    int *fields;                    /* --convert: each row's JOB_FIELDS, 0-padded */
+    int first_idx;                  /* from the prefix sum */
+    job_t *next_first;              /* first job of the next non-empty block */
+    pthread_barrier_t *counted;
+} csv_chunk_t;
+
+static csv_chunk_t *csv_chunks;     /* blocks stay allocated until exit */
+static int csv_nchunks;
+static int csv_keep_fields = 0;     /* --convert wants the raw columns too */
+
+void rrt_load(csv_chunk_t *c, const char *data, size_t size, const char *fname);
+int rrt_is_trace(const char *data, size_t size);
+void swf_parse_chunk(csv_chunk_t *c);
+int swf_wanted(const char *fname);
+
+void csv_chunk_reserve(csv_chunk_t *c, int cap) {
+    c->cap = cap;
+    c->jobs = realloc(c->jobs, (size_t)cap * sizeof(job_t));
+    if (!c->jobs) { perror("realloc"); exit(1); }
+    if (csv_keep_fields) {
+        c->fields = realloc(c->fields, (size_t)cap * JOB_FIELDS * sizeof(int));
+        if (!c->fields) { perror("realloc"); exit(1); }
+    }
+}
+
+/* One row's numbers, in CSV order (then processors); `parsed` = how many
+   leading fields converted. id, idx and next are filled in when the
+   blocks are stitched. */
+void add_job(csv_chunk_t *c, const int *v, int parsed) {
+    if (c->count == c->cap)
+        csv_chunk_reserve(c, c->cap ? c->cap * 2 : (int)((c->end - c->begin) / 16) + 16);
+    if (csv_keep_fields) {
+        int *f = &c->fields[(size_t)c->count * JOB_FIELDS];
+        memcpy(f, v, parsed * sizeof(int));
+        memset(f + parsed, 0, (JOB_FIELDS - parsed) * sizeof(int));
+    }
+    job_t *j = &c->jobs[c->count++];
+    memset(j, 0, sizeof(*j));
+    j->arrival = v[0];
+    j->priority = v[1];
+    j->total_cpu = v[2];
+    j->remaining = v[2];
+    j->deadline = parsed >= 9 && v[8] > 0 ? v[8] : -1;
+    j->quantum = parsed >= 10 && v[9] > 0 ? v[9] : 0;
+    j->job_class = parsed >= 11 ? v[10] : 0;
+    j->user = parsed >= 12 ? v[11] : 0;
+    j->group = parsed >= 13 ? v[12] : 0;
+    j->memory = parsed >= 4 ? v[3] : 0;
+    j->procs = parsed >= 14 && v[13] > 0 ? v[13] : 1;
+    j->pid = -1;
+    j->pidfd = -1;
+    j->worker = -1;
+    j->cg_fd = j->cg_events_fd = -1;
+    j->pinned_cpu = -1;
+    j->state = NOT_STARTED;
+}
+
+/* Bit i of *commas / *newlines set <=> p[i] is ',' / '\n', for 64 bytes */
+static inline void csv_block_masks(const char *p, uint64_t *commas, uint64_t *newlines) {
+#if defined(__AVX2__)
+    __m256i c = _mm256_set1_epi8(','), n = _mm256_set1_epi8('\n');
+    __m256i lo = _mm256_loadu_si256((const __m256i *)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(p + 32));
+    *commas = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c)) |
+              (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)) << 32;
+    *newlines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, n)) |
+                (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, n)) << 32;
+#elif defined(__SSE2__)
+    __m128i c = _mm_set1_epi8(','), n = _mm_set1_epi8('\n');
+    uint64_t cm = 0, nm = 0;
+    for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + 16 * k));
+        cm |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, c)) << (16 * k);
+        nm |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, n)) << (16 * k);
+    }
+    *commas = cm;
+    *newlines = nm;
+#else
+    uint64_t cm = 0, nm = 0;
+    for (int k = 0; k < 64; k++) {
+        cm |= (uint64_t)(p[k] == ',') << k;
+        nm |= (uint64_t)(p[k] == '\n') << k;
+    }
+    *commas = cm;
+    *newlines = nm;
+#endif
+}
+
+/* Parse a %d-style integer from [p, end). `limit` is how far 8-byte loads
+   may safely read. Returns 0 = no number, 1 = number filling the field,
+   2 = number followed by other characters. */
+static inline int csv_parse_int(const char *p, const char *end, const char *limit, int *out) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    int neg = 0;
+    if (p < end && (*p == '-' || *p == '+')) { neg = *p == '-'; p++; }
+
+    uint64_t v = 0;
+    int any = 0;
+    while (p < end) {
+        int n;
+        if (p + 8 <= limit) {
+            /* Count the leading digit bytes of an 8-byte word, then fold
+               them into a number with three multiplies */
+            uint64_t w;
+            memcpy(&w, p, 8);
+            uint64_t x = w ^ 0x3030303030303030ULL;
+            uint64_t bad = (x | (x + 0x0606060606060606ULL)) & 0xF0F0F0F0F0F0F0F0ULL;
+            n = bad ? __builtin_ctzll(bad) / 8 : 8;
+            if (n > end - p) n = end - p;
+            if (n == 0) break;
+            uint64_t d = x << (8 * (8 - n));
+            d = (d * 10 + (d >> 8)) & 0x00FF00FF00FF00FFULL;
+            d = (d * 100 + (d >> 16)) & 0x0000FFFF0000FFFFULL;
+            d = (d * 10000 + (d >> 32)) & 0xFFFFFFFFULL;
+            static const uint64_t pow10[9] = { 1, 10, 100, 1000, 10000, 100000,
+                                               1000000, 10000000, 100000000 };
+            v = v * pow10[n] + d;
+        } else {
+            for (n = 0; p + n < end && p[n] >= '0' && p[n] <= '9'; n++)
+                v = v * 10 + (p[n] - '0');
+            if (n == 0) break;
+            p += n;
+            any = 1;
+            break;
+        }
+        p += n;
+        any = 1;
+        if (n < 8) break;
+    }
+    if (!any) return 0;
+    *out = neg ? -(int)v : (int)v;
+    return p == end ? 1 : 2;
+}
+
+/* Whole file in memory: mmap for regular files, read() for the rest */
+char *csv_map(const char *fname, size_t *size, int *mapped) {
+    int fd = open(fname, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { perror("open"); exit(1); }
+    struct stat st;
+    if (fstat(fd, &st) < 0) { perror("fstat"); exit(1); }
+
+    char *data = NULL;
+    *mapped = 0;
+    *size = 0;
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            *size = st.st_size;
+            *mapped = 1;
+            close(fd);
+            return data;
+        }
+        data = NULL;
+    }
+
+    size_t cap = 0;
+    for (;;) {
+        if (*size == cap) {
+            cap = cap ? cap * 2 : 1 << 16;
+            data = realloc(data, cap);
+            if (!data) { perror("realloc"); exit(1); }
+        }
+        ssize_t r = read(fd, data + *size, cap - *size);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) { perror("read"); exit(1); }
+        if (r == 0) break;
+        *size += r;
+    }
+    close(fd);
+    return data;
+}
+
+/* Parse the rows of one chunk into its block */
+void csv_parse_chunk(csv_chunk_t *c) {
+    const char *data = c->data;
+    const char *limit = data + c->size;
+    size_t end = c->end;
+
+    int v[CSV_MAX_FIELDS];
+    int field = 0, parsed = 0, stopped = 0;
+    size_t line_start = c->begin, field_start = c->begin;
+
+    for (size_t base = c->begin; base < end + 1; base += 64) {
+        uint64_t commas, newlines;
+        if (base + 64 <= c->size) {
+            csv_block_masks(data + base, &commas, &newlines);
+        } else {
+            /* Past the end of the file: pad with '\n' so an unterminated
+               final row still ends */
+            char tail[64];
+            size_t n = c->size - base;
+            memcpy(tail, data + base, n);
+            memset(tail + n, '\n', 64 - n);
+            csv_block_masks(tail, &commas, &newlines);
+        }
+        if (base + 64 > end) {
+            /* Keep separators inside the chunk, plus the pad '\n' at `end`
+               when the file's last row has none */
+            size_t n = end - base;
+            commas &= (1ULL << n) - 1;
+            newlines &= (2ULL << n) - 1;
+            if (end < c->size || end == c->begin || data[end - 1] == '\n')
+                newlines &= ~(1ULL << n);
+        }
+
+        uint64_t seps = commas | newlines;
+        while (seps) {
+            int b = __builtin_ctzll(seps);
+            seps &= seps - 1;
+            size_t at = base + b;
+
+            if (!stopped && field < CSV_MAX_FIELDS) {
+                int r = csv_parse_int(data + field_start, data + at, limit, &v[field]);
+                if (r == 0) stopped = 1;
+                else {
+                    parsed = field + 1;
+                    if (r == 2) stopped = 1;
+                }
+            }
+            field++;
+            field_start = at + 1;
+
+            if (newlines >> b & 1) {
+                if (at - line_start >= 2 && data[line_start] != '#' && parsed >= 3)
+                    add_job(c, v, parsed);
+                field = parsed = stopped = 0;
+                line_start = at + 1;
+            }
+        }
+    }
+}
+
+/* Give the block's records their ids and link them, then on to the next
+   block */
+void csv_stitch_chunk(csv_chunk_t *c) {
+    for (int i = 0; i < c->count; i++) {
+        job_t *j = &c->jobs[i];
+        j->idx = c->first_idx + i;
+        j->id = j->idx + 1;
+        j->next = i + 1 < c->count ? &c->jobs[i + 1] : c->next_first;
+    }
+}
+
+/* CSV or SWF, whichever load_jobs() found */
+static void (*parse_chunk)(csv_chunk_t *c) = csv_parse_chunk;
+
+void *csv_loader_thread(void *arg) {
+    csv_chunk_t *c = arg;
+    parse_chunk(c);
+    pthread_barrier_wait(c->counted);   /* main runs the prefix sum */
+    pthread_barrier_wait(c->counted);
+    csv_stitch_chunk(c);
+    return NULL;
+}
+
+int csv_thread_count(size_t size) {
+    int n = load_threads;
+    if (n <= 0) {
+        cpu_set_t allowed;
+        n = sched_getaffinity(0, sizeof(allowed), &allowed) == 0 ? CPU_COUNT(&allowed) : 1;
+        if (n > 16) n = 16;
+    }
+    size_t by_size = size / CSV_MIN_CHUNK + 1;
+    if ((size_t)n > by_size) n = (int)by_size;
+    return n < 1 ? 1 : n;
+}
+
+void load_jobs(const char *fname) {
+    size_t size;
+    int mapped;
+    char *data = csv_map(fname, &size, &mapped);
+
+    if (rrt_is_trace(data, size)) {
+        csv_chunks = calloc(1, sizeof(csv_chunk_t));
+        if (!csv_chunks) { perror("calloc"); exit(1); }
+        csv_nchunks = 1;
+        rrt_load(&csv_chunks[0], data, size, fname);
+        csv_stitch_chunk(&csv_chunks[0]);
+        input_head = csv_chunks[0].count ? &csv_chunks[0].jobs[0] : NULL;
+        if (mapped) munmap(data, size);
+        else free(data);
+        return;
+    }
+
+    parse_chunk = swf_wanted(fname) ? swf_parse_chunk : csv_parse_chunk;
+
+    /* Cut at line starts: each cut moves forward past the next '\n' */
+    int n = csv_thread_count(size);
+    csv_chunk_t *chunks = calloc(n, sizeof(csv_chunk_t));
+    if (!chunks) { perror("calloc"); exit(1); }
+    size_t pos = 0;
+    for (int i = 0; i < n; i++) {
+        size_t cut = i == n - 1 ? size : size / n * (i + 1);
+        if (cut < pos) cut = pos;
+        if (cut > 0 && cut < size && data[cut - 1] != '\n') {
+            const char *nl = memchr(data + cut, '\n', size - cut);
+            cut = nl ? (size_t)(nl - data) + 1 : size;
+        }
+        chunks[i].data = data;
+        chunks[i].size = size;
+        chunks[i].begin = pos;
+        chunks[i].end = cut;
+        pos = cut;
+    }
+
+    pthread_barrier_t counted;
+    pthread_t *tids = calloc(n, sizeof(pthread_t));
+    int threaded = n > 1;
+    if (threaded) {
+        pthread_barrier_init(&counted, NULL, n + 1);
+        for (int i = 0; i < n; i++) {
+            chunks[i].counted = &counted;
+            if (pthread_create(&tids[i], NULL, csv_loader_thread, &chunks[i]) != 0) {
+                perror("pthread_create");
+                exit(1);
+            }
+        }
+        pthread_barrier_wait(&counted);
+    } else {
+        parse_chunk(&chunks[0]);
+    }
+
+    /* Prefix sum of the counts, and who follows whom */
+    int total = 0;
+    job_t *next_first = NULL;
+    for (int i = 0; i < n; i++) {
+        chunks[i].first_idx = total;
+        total += chunks[i].count;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        chunks[i].next_first = next_first;
+        if (chunks[i].count) next_first = &chunks[i].jobs[0];
+    }
+    input_head = next_first;
+
+    if (threaded) {
+        pthread_barrier_wait(&counted);
+        for (int i = 0; i < n; i++) pthread_join(tids[i], NULL);
+        pthread_barrier_destroy(&counted);
+    } else {
+        csv_stitch_chunk(&chunks[0]);
+    }
+    free(tids);
+
+    csv_chunks = chunks;
+    csv_nchunks = n;
+    if (mapped) munmap(data, size);
+    else free(data);
+}
+
+void free_jobs() {
+    for (int i = 0; i < csv_nchunks; i++) {
+        free(csv_chunks[i].jobs);
+        free(csv_chunks[i].fields);
+    }
+    free(csv_chunks);
+}
+
+/* Preemptions plain single-CPU RR with q=1 would make on the loaded trace:
+   the same per-tick steps as the main loop, on bare arrays */
+long rr_q1_preemptions() {
+    int n = 0;
+    for (job_t *p = input_head; p; p = p->next) n++;
+    int *rem = malloc(n * sizeof(int));
+    int *ring = malloc(n * sizeof(int));
+    int i = 0;
+    for (job_t *p = input_head; p; p = p->next) rem[i++] = p->total_cpu;
+
+    job_t *next = input_head;
+    int idx = 0, head = 0, len = 0, cur = -1, left = n, t = 0;
+    long count = 0;
+    while (left) {
+        while (next && next->arrival <= t) {
+            ring[(head + len++) % n] = idx++;
+            next = next->next;
+        }
+        if (cur >= 0) {
+            if (--rem[cur] <= 0) { cur = -1; left--; }
+            else if (len) { ring[(head + len++) % n] = cur; cur = -1; count++; }
+        }
+        if (cur < 0 && len) { cur = ring[head]; head = (head + 1) % n; len--; }
+        if (!left) break;
+
+        int to = t + 1;
+        if (len == 0) {
+            int horizon = next ? next->arrival : INT_MAX;
+            if (cur >= 0 && t + rem[cur] < horizon) horizon = t + rem[cur];
+            if (horizon > to && horizon != INT_MAX) to = horizon;
+        }
+        if (cur >= 0) rem[cur] -= to - (t + 1);
+        t = to;
+    }
+    free(rem);
+    free(ring);
+    return count;
+}
+
+/* ---------------- BINARY TRACES ---------------- */
+/* `dispatcher --convert in.csv out.rrt` writes a trace as columns, so a
+   replay skips CSV parsing. load_jobs() recognizes the file by its magic,
+   whatever its name.
+
+   Layout (little-endian): an rrt_header_t, then the column table (ncols
+   uint64_t start offsets, then ncols uint64_t byte lengths), then one
+   column per CSV position, each starting on an 8-byte boundary. Arrival is a varint
+   stream of zigzagged deltas from the previous row's arrival (sorted
+   traces need about one byte a job). Every other column is a plain
+   int32_t array of `count` entries. Fields a CSV row did not have are 0,
+   and the same defaults apply on load as for CSV (deadline <= 0 = none,
+   and so on), so a converted trace runs exactly like its source. p4-p7
+   have no job_t field; they are carried, not used. Version 2 added the
+   processors column for SWF traces; version 1 files load with one
+   processor a job.
+
+   The reader maps the file, allocates one block for `count` jobs from the
+   header and fills it in a single pass; no job is allocated alone. A
+   header with another version is refused rather than guessed at. */
+
+#define RRT_MAGIC "RRTRACE"
+#define RRT_VERSION 2
+
+enum {
+    RRT_ARRIVAL, RRT_PRIORITY, RRT_SERVICE, RRT_MEMORY,
+    RRT_P4, RRT_P5, RRT_P6, RRT_P7,
+    RRT_DEADLINE, RRT_QUANTUM, RRT_CLASS, RRT_USER, RRT_GROUP,
+    RRT_PROCS,                      /* version 2 */
+    RRT_COLS
+};
+
+#define RRT_V1_COLS RRT_PROCS
+
+typedef struct {
+    char magic[8];                  /* RRT_MAGIC, NUL-terminated */
+    uint32_t version;               /* RRT_VERSION */
+    uint32_t ncols;                 /* entries in the column table */
+    uint64_t count;                 /* jobs */
+    int32_t min_arrival, max_arrival;
+} rrt_header_t;
+
+int rrt_is_trace(const char *data, size_t size) {
+    return size >= sizeof(RRT_MAGIC) && memcmp(data, RRT_MAGIC, sizeof(RRT_MAGIC)) == 0;
+}
+
+static void rrt_bad(const char *fname, const char *why) {
+    fprintf(stderr, "%s: bad .rrt trace: %s\n", fname, why);
+    exit(1);
+}
+
+void rrt_load(csv_chunk_t *c, const char *data, size_t size, const char *fname) {
+    rrt_header_t h;
+    if (size < sizeof(h)) rrt_bad(fname, "truncated header");
+    memcpy(&h, data, sizeof(h));
+    if (h.version < 1 || h.version > RRT_VERSION) {
+        fprintf(stderr, "%s: .rrt version %u, this dispatcher reads versions 1-%d\n",
+                fname, h.version, RRT_VERSION);
+        exit(1);
+    }
+    int ncols = h.version == 1 ? RRT_V1_COLS : RRT_COLS;
+    if (h.ncols < (uint32_t)ncols) rrt_bad(fname, "missing columns");
+    if (h.ncols > (size - sizeof(h)) / 16) rrt_bad(fname, "truncated column table");
+    if (h.count > INT_MAX) rrt_bad(fname, "too many jobs");
+
+    uint64_t off[RRT_COLS], len[RRT_COLS];
+    for (int k = 0; k < ncols; k++) {
+        memcpy(&off[k], data + sizeof(h) + 8 * k, 8);
+        memcpy(&len[k], data + sizeof(h) + 8 * (h.ncols + k), 8);
+        if (off[k] > size || len[k] > size - off[k]) rrt_bad(fname, "column past end of file");
+        if (k != RRT_ARRIVAL && (off[k] % 4 || len[k] != h.count * sizeof(int32_t)))
+            rrt_bad(fname, "column size does not match job count");
+    }
+
+    int n = (int)h.count;
+    if (n) csv_chunk_reserve(c, n);
+    const int32_t *col[RRT_COLS];
+    for (int k = 0; k < ncols; k++) col[k] = (const int32_t *)(data + off[k]);
+
+    const unsigned char *a = (const unsigned char *)data + off[RRT_ARRIVAL];
+    const unsigned char *a_end = a + len[RRT_ARRIVAL];
+    int64_t arrival = 0;
+    int v[JOB_FIELDS];
+    for (int i = 0; i < n; i++) {
+        uint64_t z = 0;
+        for (int shift = 0; ; shift += 7) {
+            if (a == a_end || shift > 63) rrt_bad(fname, "arrival column cut short");
+            z |= (uint64_t)(*a & 0x7f) << shift;
+            if (!(*a++ & 0x80)) break;
+        }
+        arrival += (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+        v[RRT_ARRIVAL] = (int)arrival;
+        for (int k = 1; k < ncols; k++) v[k] = col[k][i];
+        add_job(c, v, ncols);
+    }
+}
+
+static void rrt_write(FILE *f, const void *p, size_t n, const char *fname) {
+    if (n && fwrite(p, 1, n, f) != n) { perror(fname); exit(1); }
+}
+
+/* --convert: load `in` (CSV, SWF or .rrt) and write it to `out` */
+void convert_trace(const char *in, const char *out) {
+    csv_keep_fields = 1;
+    load_jobs(in);
+
+    int n = 0;
+    for (int i = 0; i < csv_nchunks; i++) n += csv_chunks[i].count;
+
+    rrt_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, RRT_MAGIC, sizeof(RRT_MAGIC));
+    h.version = RRT_VERSION;
+    h.ncols = RRT_COLS;
+    h.count = n;
+
+    /* Arrival deltas: at most 10 varint bytes each */
+    unsigned char *arr = malloc((size_t)n * 10 + 1);
+    int32_t *colbuf = malloc((size_t)n * sizeof(int32_t) + 1);
+    if (!arr || !colbuf) { perror("malloc"); exit(1); }
+    size_t alen = 0;
+    int64_t prev = 0;
+    int first = 1;
+    for (int i = 0; i < csv_nchunks; i++) {
+        for (int r = 0; r < csv_chunks[i].count; r++) {
+            int a = csv_chunks[i].fields[(size_t)r * JOB_FIELDS + RRT_ARRIVAL];
+            if (first || a < h.min_arrival) h.min_arrival = a;
+            if (first || a > h.max_arrival) h.max_arrival = a;
+            first = 0;
+            int64_t d = a - prev;
+            uint64_t z = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+            while (z >= 0x80) { arr[alen++] = (unsigned char)(z | 0x80); z >>= 7; }
+            arr[alen++] = (unsigned char)z;
+            prev = a;
+        }
+    }
+
+    uint64_t off[RRT_COLS], len[RRT_COLS];
+    uint64_t pos = sizeof(h) + sizeof(off) + sizeof(len);
+    for (int k = 0; k < RRT_COLS; k++) {
+        off[k] = pos;
+        len[k] = k == RRT_ARRIVAL ? alen : (uint64_t)n * sizeof(int32_t);
+        pos = (pos + len[k] + 7) & ~7ULL;
+    }
+
+    FILE *f = fopen(out, "wb");
+    if (!f) { perror(out); exit(1); }
+    static const char pad[8];
+    rrt_write(f, &h, sizeof(h), out);
+    rrt_write(f, off, sizeof(off), out);
+    rrt_write(f, len, sizeof(len), out);
+    uint64_t at = sizeof(h) + sizeof(off) + sizeof(len);
+    for (int k = 0; k < RRT_COLS; k++) {
+        rrt_write(f, pad, off[k] - at, out);
+        if (k == RRT_ARRIVAL) {
+            rrt_write(f, arr, alen, out);
+        } else {
+            int w = 0;
+            for (int i = 0; i < csv_nchunks; i++)
+                for (int r = 0; r < csv_chunks[i].count; r++)
+                    colbuf[w++] = csv_chunks[i].fields[(size_t)r * JOB_FIELDS + k];
+            rrt_write(f, colbuf, len[k], out);
+        }
+        at = off[k] + len[k];
+    }
+    if (fclose(f) != 0) { perror(out); exit(1); }
+
+    printf("%s: %d jobs, arrivals %d..%d, %llu bytes\n", out, n,
+           n ? h.min_arrival : 0, n ? h.max_arrival : 0, (unsigned long long)at);
+    free(arr);
+    free(colbuf);
+    free_jobs();
+}
+
+/* ---------------- SWF TRACES ---------------- */
+/* Standard Workload Format, as in the Parallel Workloads Archive: one job
+   per line, 18 whitespace-separated numbers, -1 for unknown, ';' header
+   comments. A trace is read as SWF with --swf or when its name ends in
+   .swf. It goes through the same mapping, chunking and threads as a CSV
+   trace; only the per-chunk parse differs.
+
+   submit time (field 2)       -> arrival
+   run time (4)                -> service; jobs without one are skipped
+   requested processors (8)    -> procs, else allocated processors (5)
+   requested memory (10)       -> memory, else used memory (7)
+   executable (14)             -> job_class, so SJF learns per program
+   user (12), group (13)       -> user, group
+
+   --swf-tick S makes one tick S seconds of trace time (default 1).
+   Arrivals round down and run times round up, so every job gets at least
+   one tick. --swf-status and --swf-queue take comma-separated lists and
+   keep only jobs whose status (11) or queue (15) is listed. */
+
+#define SWF_FIELDS 18
+#define SWF_MAX_FILTER 64
+
+enum {
+    SWF_JOB, SWF_SUBMIT, SWF_WAIT, SWF_RUN, SWF_ALLOC_PROCS, SWF_AVG_CPU,
+    SWF_USED_MEM, SWF_REQ_PROCS, SWF_REQ_TIME, SWF_REQ_MEM, SWF_STATUS,
+    SWF_USER, SWF_GROUP, SWF_EXEC, SWF_QUEUE, SWF_PARTITION, SWF_PRECEDING,
+    SWF_THINK
+};
+
+static int swf_input = 0;           /* --swf */
+static double swf_tick = 1.0;       /* --swf-tick: seconds per tick */
+
+typedef struct {
+    int n;                          /* 0 = keep everything */
+    long long v[SWF_MAX_FILTER];
+} swf_filter_t;
+
+static swf_filter_t swf_status, swf_queue;
+
+int swf_wanted(const char *fname) {
+    size_t len = strlen(fname);
+    return swf_input || (len > 4 && strcmp(fname + len - 4, ".swf") == 0);
+}
+
+/* "1,0,5" -> filter; returns 0 on anything but a list of integers */
+int swf_parse_filter(const char *s, swf_filter_t *f) {
+    f->n = 0;
+    while (*s) {
+        char *end;
+        long long v = strtoll(s, &end, 10);
+        if (end == s || (*end && *end != ',') || f->n == SWF_MAX_FILTER) return 0;
+        f->v[f->n++] = v;
+        s = *end ? end + 1 : end;
+    }
+    return f->n > 0;
+}
+
+static int swf_keep(const swf_filter_t *f, long long v) {
+    if (!f->n) return 1;
+    for (int i = 0; i < f->n; i++)
+        if (f->v[i] == v) return 1;
+    return 0;
+}
+
+static int swf_int(long long v) {
+    return v > INT_MAX ? INT_MAX : v < INT_MIN ? INT_MIN : (int)v;
+}
+
+/* Parse one line's fields; returns how many, or -1 if one is not a
+   number. Fractional values (some logs have them) keep their integer
+   part. */
+static int swf_split(const char *p, const char *end, long long *f) {
+    int n = 0;
+    for (;;) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        if (p == end || n == SWF_FIELDS) return n;
+        int neg = 0;
+        if (*p == '-' || *p == '+') { neg = *p == '-'; p++; }
+        if (p == end || *p < '0' || *p > '9') return -1;
+        long long v = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (v < LLONG_MAX / 10) v = v * 10 + (*p - '0');
+            p++;
+        }
+        if (p < end && *p == '.')
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++) ;
+        if (p < end && *p != ' ' && *p != '\t' && *p != '\r') return -1;
+        f[n++] = neg ? -v : v;
+    }
+}
+
+void swf_parse_chunk(csv_chunk_t *c) {
+    const char *p = c->data + c->begin, *stop = c->data + c->end;
+    long long f[SWF_FIELDS];
+    int v[JOB_FIELDS];
+
+    while (p < stop) {
+        const char *nl = memchr(p, '\n', stop - p);
+        const char *end = nl ? nl : stop;
+        const char *line = p;
+        p = nl ? nl + 1 : stop;
+
+        while (line < end && (*line == ' ' || *line == '\t')) line++;
+        if (line == end || *line == ';') continue;
+        int n = swf_split(line, end, f);
+        if (n <= SWF_RUN) continue;
+        for (int k = n; k < SWF_FIELDS; k++) f[k] = -1;
+
+        if (f[SWF_SUBMIT] < 0 || f[SWF_RUN] < 0) continue;
+        if (!swf_keep(&swf_status, f[SWF_STATUS]) || !swf_keep(&swf_queue, f[SWF_QUEUE]))
+            continue;
+
+        long long procs = f[SWF_REQ_PROCS] > 0 ? f[SWF_REQ_PROCS] : f[SWF_ALLOC_PROCS];
+        long long memory = f[SWF_REQ_MEM] > 0 ? f[SWF_REQ_MEM] : f[SWF_USED_MEM];
+        double run = ceil(f[SWF_RUN] / swf_tick);
+
+        memset(v, 0, sizeof(v));
+        v[RRT_ARRIVAL] = swf_int((long long)floor(f[SWF_SUBMIT] / swf_tick));
+        v[RRT_SERVICE] = run < 1 ? 1 : run > INT_MAX ? INT_MAX : (int)run;
+        v[RRT_MEMORY] = memory > 0 ? swf_int(memory) : 0;
+        v[RRT_CLASS] = f[SWF_EXEC] > 0 ? swf_int(f[SWF_EXEC]) : 0;
+        v[RRT_USER] = f[SWF_USER] > 0 ? swf_int(f[SWF_USER]) : 0;
+        v[RRT_GROUP] = f[SWF_GROUP] > 0 ? swf_int(f[SWF_GROUP]) : 0;
+        v[RRT_PROCS] = procs > 0 ? swf_int(procs) : 1;
+        add_job(c, v, JOB_FIELDS);
+    }
+}
+
+/* ---------------- PRINT FUNCTIONS ---------------- */
+void print_job_table() {
+    printf("\n==================== JOB TABLE ====================\n");
+    printf(" Job ID | Arrival | CPU Burst | Priority | Deadline\n");
+    printf("--------+---------+-----------+----------+----------\n");
+
+    job_t *p = input_head;
+    while (p) {
+        printf("   %-4d |   %-5d |    %-5d  |    %-5d |", p->id, p->arrival, p->total_cpu, p->priority);
+        if (p->deadline < 0) printf("    -\n");
+        else printf("    %d\n", p->deadline);
+        p = p->next;
+    }
+    printf("===================================================\n\n");
+}
+
+/* Span of row `r` covering tick `t`; `cursor` only moves forward */
+gantt_span_t *gantt_at(gantt_row_t *r, int *cursor, int t) {
+    while (*cursor < r->count && r->spans[*cursor].start + r->spans[*cursor].len <= t)
+        (*cursor)++;
+    return &r->spans[*cursor];
+}
+
+void print_gantt_chart() {
+    printf("\n==================== GANTT CHART ====================\n");
+    if (quiet) {
+        long spans = 0;
+        for (int i = 0; i < ncpus; i++) spans += cpus[i].gantt.count;
+        printf("%d ticks, %ld spans (not printed under --quiet)\n", cpus[0].gantt.ticks, spans);
+        printf("=====================================================\n\n");
+        return;
+    }
+
+    /* Columns: one per tick, except that a stretch where every core is
+       idle for GANTT_IDLE_COLLAPSE+ ticks collapses into one column */
+    typedef struct { int start, len, width; } column_t;
+    int ticks = cpus[0].gantt.ticks;
+    column_t *cols = malloc((ticks + 1) * sizeof(column_t));
+    int ncols = 0;
+    int *cursor = calloc(ncpus, sizeof(int));
+    for (int t = 0; t < ticks; ) {
+        int idle = INT_MAX;
+        for (int i = 0; i < ncpus; i++) {
+            gantt_span_t *g = gantt_at(&cpus[i].gantt, &cursor[i], t);
+            if (g->id != -1) { idle = 0; break; }
+            if (g->start + g->len - t < idle) idle = g->start + g->len - t;
+        }
+        column_t *col = &cols[ncols++];
+        col->start = t;
+        col->len = idle >= GANTT_IDLE_COLLAPSE ? idle : 1;
+        col->width = 4;
+        if (col->len > 1) {
+            char cell[32];
+            int w = snprintf(cell, sizeof(cell), " -x%d ", col->len);
+            if (w > 4) col->width = w;
+        }
+        t += col->len;
+    }
+
+    printf("Time:  ");
+    for (int k = 0; k < ncols; k++) printf("%-*d", cols[k].width, cols[k].start);
+
+    for (int i = 0; i < ncpus; i++) {
+        if (ncpus == 1) printf("\nCPU:   ");
+        else printf("\nCPU%-3d ", i);
+        int cur = 0;
+        for (int k = 0; k < ncols; k++) {
+            if (cols[k].len > 1) {
+                char cell[32];
+                snprintf(cell, sizeof(cell), " -x%d ", cols[k].len);
+                printf("%-*s", cols[k].width, cell);
+                continue;
+            }
+            gantt_span_t *g = gantt_at(&cpus[i].gantt, &cur, cols[k].start);
+            if (g->id == -1) printf(" -  ");
+            else printf("J%-2d ", g->id);
+        }
+    }
+    free(cursor);
+    free(cols);
+
+    if (ncpus == 1 && policy == &rr_policy && !*policy_opts) {
+        printf("\n\nExpected (Stallings Fig 9.5):\n");
+        printf("CPU:   J1  J1  J2  J1  J2  J3  J2  J4  J3  J2  J5  J4  J3  J2  J5  J4  J3  J2  J4  J4\n");
+    } else {
+        printf("\n");
+    }
+    printf("=====================================================\n\n");
+}
+
+/* Per-core share of the run (multi-CPU mode) */
+void print_cpu_utilization(int ticks) {
+    printf("\n================== CPU UTILIZATION ==================\n");
+    printf(" CPU | Host | Busy ticks | Utilization | Dispatches | Steals\n");
+    printf("-----+------+------------+-------------+------------+-------\n");
+    for (int i = 0; i < ncpus; i++) {
+        cpu_t *c = &cpus[i];
+        printf(" %-3d | %-4d | %-10ld |    %6.2f%%  | %-10ld | %ld\n",
+               c->id, c->core, c->busy_ticks,
+               ticks ? 100.0 * c->busy_ticks / ticks : 0.0, c->dispatches, c->steals);
+    }
+    printf("=====================================================\n");
+}
+
+int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* Jobs with a deadline column: misses and the spread of lateness
+   (completion - deadline, negative = early). Crashed jobs are left out. */
+void print_deadline_stats(job_stat_t stats[], int n) {
+    int *late = malloc(n * sizeof(int));
+    int count = 0, misses = 0;
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        if (stats[i].deadline < 0 || stats[i].crashed) continue;
+        int l = stats[i].completion - stats[i].deadline;
+        late[count++] = l;
+        if (l > 0) misses++;
+        sum += l;
+    }
+    if (count) {
+        qsort(late, count, sizeof(int), cmp_int);
+        printf("Deadline misses: %d of %d (%.1f%%)\n", misses, count, 100.0 * misses / count);
+        printf("Lateness: min %d  p50 %d  p90 %d  p99 %d  max %d  mean %.2f\n",
+               late[0], late[(count - 1) / 2], late[(int)((count - 1) * 0.9)],
+               late[(int)((count - 1) * 0.99)], late[count - 1], sum / count);
+    }
+    free(late);
+}
+
+static job_stat_t *user_sort_stats;
+
+int cmp_user(const void *a, const void *b) {
+    const job_stat_t *x = &user_sort_stats[*(const int *)a], *y = &user_sort_stats[*(const int *)b];
+    if (x->group != y->group) return (x->group > y->group) - (x->group < y->group);
+    return (x->user > y->user) - (x->user < y->user);
+}
+
+/* Traces with a user/group column: turnaround and CPU share per user. The
+   share is taken over the contended ticks, those run while at least two
+   users had jobs in the system, since whatever a lone user runs says
+   nothing about the policy. Crashed jobs count towards neither. */
+void print_user_stats(job_stat_t stats[], int n) {
+    int *order = malloc(n * sizeof(int));
+    int count = 0, tagged = 0;
+    long total_cpu = 0, total_contended = 0;
+    for (int i = 0; i < n; i++) {
+        if (stats[i].crashed) continue;
+        if (stats[i].user || stats[i].group) tagged = 1;
+        order[count++] = i;
+        total_cpu += stats[i].burst;
+        total_contended += stats[i].contended;
+    }
+    if (!tagged || !total_cpu) { free(order); return; }
+
+    user_sort_stats = stats;
+    qsort(order, count, sizeof(int), cmp_user);
+
+    printf("\n Group | User  | Jobs  | CPU ticks | Contended | CPU share | Avg Turnaround\n");
+    printf("-------+-------+-------+-----------+-----------+-----------+----------------\n");
+    for (int i = 0; i < count; ) {
+        job_stat_t *first = &stats[order[i]];
+        long cpu = 0, contended = 0;
+        double ta = 0;
+        int jobs = 0;
+        for (; i < count && cmp_user(&order[i], &order[i - jobs]) == 0; i++, jobs++) {
+            cpu += stats[order[i]].burst;
+            contended += stats[order[i]].contended;
+            ta += stats[order[i]].completion - stats[order[i]].arrival;
+        }
+        printf(" %-5d | %-5d | %-5d | %-9ld | %-9ld | ", first->group, first->user, jobs, cpu, contended);
+        if (total_contended) printf(" %6.2f%%  | %.2f\n", 100.0 * contended / total_contended, ta / jobs);
+        else printf("    -      | %.2f\n", ta / jobs);
+    }
+    free(order);
+}
+
+void print_statistics(job_stat_t stats[], int n) {
+    printf("==================== STATISTICS ====================\n");
+    const char *extra = policy->stat_name;
+    if (!quiet) {
+        printf(" Job ID | Arrival | Burst | Completion | Turnaround | Waiting");
+        if (extra) printf(" | %s", extra);
+        printf("\n--------+---------+-------+------------+------------+---------");
+        if (extra) printf("+-%.*s", (int)strlen(extra) + 1, "--------------------------------");
+        printf("\n");
+    }
+    
+    long long total_ta = 0, total_wt = 0;   /* exact at any job count */
+    int done = 0, crashes = 0;
+    
+    for (int i = 0; i < n; i++) {
+        job_stat_t *st = &stats[i];
+        int ta = st->completion - st->arrival;
+        int wt = ta - st->burst;
+
+        /* A crashed job never got its full burst: show it, keep it out of the averages */
+        if (st->crashed) {
+            crashes++;
+            if (!quiet)
+                printf("   %-4d |   %-5d |  %-4d |    %-7d |    CRASHED |   -\n",
+                       st->id, st->arrival, st->burst, st->completion);
+            continue;
+        }
+        total_ta += ta;
+        total_wt += wt;
+        done++;
+        if (quiet) continue;
+        
+        printf("   %-4d |   %-5d |  %-4d |    %-7d |    %-7d |   %-5d",
+               st->id, st->arrival, st->burst, st->completion, ta, wt);
+        if (extra) printf(" | %.2f", st->policy_stat);
+        printf("\n");
+    }
+    
+    if (quiet) printf("%d jobs (per-job rows not printed under --quiet)\n", n);
+    printf("----------------------------------------------------\n");
+    printf("Average Turnaround Time: %.2f\n", done ? (double)total_ta / done : 0.0);
+    printf("Average Waiting Time: %.2f\n", done ? (double)total_wt / done : 0.0);
+    if (crashes) printf("Crashed jobs: %d\n", crashes);
+    print_deadline_stats(stats, n);
+    print_user_stats(stats, n);
+    if (policy->report) {
+        void **selves = malloc(ncpus * sizeof(void *));
+        for (int i = 0; i < ncpus; i++) selves[i] = cpus[i].rq;
+        policy->report(selves, ncpus);
+        free(selves);
+    }
+    printf("====================================================\n");
+}
+
+/* How many suspend/resume pairs the policy saved over RR q=1 */
+void print_context_switches(long baseline) {
+    long saved = baseline - preemptions;
+    printf("Context switches: %ld (RR q=1 on this trace: %ld, saved %ld", preemptions, baseline, saved);
+    if (baseline > 0) printf(" = %.1f%%", 100.0 * saved / baseline);
+    printf(")\n");
+}
+
+/* ---------------- TICK ENGINE ---------------- */
+
+int64_t ts_to_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+struct timespec ns_to_ts(int64_t ns) {
+    struct timespec ts = { ns / 1000000000LL, ns % 1000000000LL };
+    return ts;
+}
+
+int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts_to_ns(&ts);
+}
+
+/* Start the clock: tick 0 begins now */
+void tick_engine_init() {
+    tick_ns = (int64_t)(quantum_us * 1000.0 / time_scale);
+    if (tick_ns < 1) tick_ns = 1;
+    clock_gettime(CLOCK_MONOTONIC, &tick_origin);
+    if (simulate) return;
+
+    tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tick_fd < 0) { perror("timerfd_create"); exit(1); }
+}
+
+/* ---------------- PROCESS CONTROL ---------------- */
+/* In --simulate mode these only update job state; no process is touched. */
+
+/* Readiness pipe: every jobprog inherits the write end (passed as argv[2])
+   and reports JOB_READY after exec and JOB_RESUMED after SIGCONT. */
+#define READY_TIMEOUT_MS 2000
+static int ready_pipe[2] = { -1, -1 };
+
+/* Dispatch overhead: time from spawn/SIGCONT until the child confirms
+   (SPAWN alone covers only the spawn call itself) */
+typedef struct {
+    long count;
+    int64_t total_ns;
+    int64_t max_ns;
+} latency_t;
+
+static latency_t spawn_latency, start_latency;
+
+void latency_add(latency_t *l, int64_t ns) {
+    l->count++;
+    l->total_ns += ns;
+    if (ns > l->max_ns) l->max_ns = ns;
+}
+
+void ready_pipe_init() {
+    if (simulate) return;
+    if (pipe(ready_pipe) < 0) { perror("pipe"); exit(1); }
+    /* Only the write end is handed down to jobs */
+    fcntl(ready_pipe[0], F_SETFD, FD_CLOEXEC);
+}
+
+/* Block until `pid` reports `kind`, discarding stale messages from other
+   jobs. Also watches `pidfd` (if >= 0) so a child that dies before
+   confirming is noticed at once. Returns 0 on success, -1 otherwise. */
+int wait_ready(pid_t pid, int pidfd, int kind) {
+    int64_t deadline = now_ns() + READY_TIMEOUT_MS * 1000000LL;
+    for (;;) {
+        int64_t left = deadline - now_ns();
+        if (left <= 0) break;
+        struct pollfd pfd[2] = { { ready_pipe[0], POLLIN, 0 }, { pidfd, POLLIN, 0 } };
+        int r = poll(pfd, pidfd >= 0 ? 2 : 1, (int)((left + 999999) / 1000000));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        if (!(pfd[0].revents & POLLIN)) {
+            fprintf(stderr, "warning: job pid=%d exited before confirming\n", pid);
+            return -1;
+        }
+
+        struct job_msg m;
+        if (read(ready_pipe[0], &m, sizeof(m)) != sizeof(m)) break;
+        if (m.pid == pid && m.kind == kind) return 0;
+    }
+    fprintf(stderr, "warning: job pid=%d did not confirm %s within %d ms\n",
+            pid, kind == JOB_READY ? "start" : "resume", READY_TIMEOUT_MS);
+    return -1;
+}
+
+/* ---------------- SPAWN BACKEND ---------------- */
+/* --spawn=clone (default): clone(CLONE_VM|CLONE_VFORK|CLONE_PIDFD) on a
+   small private stack, then fexecve() of the jobprog image opened once at
+   startup. Nothing of the dispatcher's address space is copied, so spawn
+   cost does not grow with the job table. --spawn=fork keeps the classic
+   fork()+exec path. --spawn=zygote delegates to a helper forked before the
+   trace is loaded (see ZYGOTE below). All hand back a pidfd used for every
+   later signal. */
+
+typedef enum { SPAWN_CLONE, SPAWN_FORK, SPAWN_ZYGOTE } spawn_mode_t;
+static spawn_mode_t spawn_mode = SPAWN_CLONE;
+static int jobprog_fd = -1;
+
+#define SPAWN_STACK_SIZE (64 * 1024)
+static char *spawn_stack = NULL;
+
+struct spawn_args {
+    char *argv[5];
+    char burst[20];
+    char fdarg[20];
+    char cmdarg[20];
+    int cmd_fd;         /* pool worker command pipe, -1 for one-shot jobs */
+};
+
+extern char **environ;
+
+int sys_pidfd_open(pid_t pid) {
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+}
+
+int sys_pidfd_send_signal(int pidfd, int sig) {
+    return (int)syscall(SYS_pidfd_send_signal, pidfd, sig, NULL, 0);
+}
+
+/* Runs in the child on spawn_stack, sharing our memory until exec */
+int spawn_child(void *arg) {
+    struct spawn_args *a = arg;
+    /* Our fd table is private: only this child keeps its command pipe */
+    if (a->cmd_fd >= 0) fcntl(a->cmd_fd, F_SETFD, 0);
+    /* The dispatcher blocks SIGCHLD/SIGPIPE for its signalfd; jobs must not */
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
+    fexecve(jobprog_fd, a->argv, environ);
+    _exit(127);
+}
+
+void zygote_start();
+
+/* Called before load_jobs so a zygote inherits only a small image */
+void spawn_init() {
+    if (simulate) return;
+    jobprog_fd = open("./jobprog", O_RDONLY | O_CLOEXEC);
+    if (jobprog_fd < 0) { perror("open ./jobprog"); exit(1); }
+    spawn_stack = malloc(SPAWN_STACK_SIZE);
+    if (!spawn_stack) { perror("malloc"); exit(1); }
+    if (spawn_mode == SPAWN_ZYGOTE) zygote_start();
+}
+
+/* Start jobprog for a job with `burst` ticks, or as a pool worker reading
+   `cmd_fd` when that is >= 0. `extra_flags` is passed to clone() as-is.
+   Returns the pid and stores a pidfd (or -1) in *pidfd. */
+pid_t spawn_jobprog(int burst, int cmd_fd, int extra_flags, int *pidfd) {
+    struct spawn_args a;
+    snprintf(a.burst, sizeof(a.burst), "%d", burst);
+    snprintf(a.fdarg, sizeof(a.fdarg), "%d", ready_pipe[1]);
+    snprintf(a.cmdarg, sizeof(a.cmdarg), "%d", cmd_fd);
+    a.cmd_fd = cmd_fd;
+    a.argv[0] = "./jobprog";
+    if (cmd_fd >= 0) {
+        a.argv[1] = "--worker";
+        a.argv[2] = a.cmdarg;
+        a.argv[3] = a.fdarg;
+        a.argv[4] = NULL;
+    } else {
+        a.argv[1] = a.burst;
+        a.argv[2] = a.fdarg;
+        a.argv[3] = NULL;
+    }
+
+    *pidfd = -1;
+    if (spawn_mode != SPAWN_FORK) {
+        pid_t pid = clone(spawn_child, spawn_stack + SPAWN_STACK_SIZE,
+                          CLONE_VM | CLONE_VFORK | CLONE_PIDFD | SIGCHLD | extra_flags,
+                          &a, pidfd);
+        if (pid > 0) return pid;
+        /* Old kernel without CLONE_PIDFD: degrade once, loudly */
+        perror("clone");
+        fprintf(stderr, "warning: falling back to --spawn=fork\n");
+        spawn_mode = SPAWN_FORK;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (cmd_fd >= 0) fcntl(cmd_fd, F_SETFD, 0);
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, NULL);
+        execv("./jobprog", a.argv);
+        perror("execv");
+        _exit(1);
+    }
+    if (pid > 0) *pidfd = sys_pidfd_open(pid);
+    return pid;
+}
+
+/* ---------------- ZYGOTE ---------------- */
+/* A helper forked before load_jobs, while the dispatcher is still small.
+   It receives spawn requests (the burst) over a socketpair, clones jobprog
+   from its own tiny image with CLONE_PARENT so the job is still our child
+   (waitpid keeps working), and sends back the pid plus the pidfd through
+   SCM_RIGHTS. Spawn cost stays flat however large the job table grows. */
+
+static int zygote_sock = -1;
+static pid_t zygote_pid = -1;
+
+/* Send an int, optionally carrying one fd as SCM_RIGHTS */
+int send_int_fd(int sock, int val, int fd) {
+    struct iovec iov = { &val, sizeof(val) };
+    union { struct cmsghdr h; char buf[CMSG_SPACE(sizeof(int))]; } u;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fd >= 0) {
+        memset(&u, 0, sizeof(u));
+        msg.msg_control = u.buf;
+        msg.msg_controllen = sizeof(u.buf);
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cm), &fd, sizeof(int));
+    }
+    return sendmsg(sock, &msg, 0) == sizeof(val) ? 0 : -1;
+}
+
+/* Receive an int and the fd attached to it (or -1). Returns -1 on EOF. */
+int recv_int_fd(int sock, int *val, int *fd) {
+    struct iovec iov = { val, sizeof(*val) };
+    union { struct cmsghdr h; char buf[CMSG_SPACE(sizeof(int))]; } u;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = u.buf;
+    msg.msg_controllen = sizeof(u.buf);
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != sizeof(*val)) return -1;
+
+    *fd = -1;
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS)
+        memcpy(fd, CMSG_DATA(cm), sizeof(int));
+    return 0;
+}
+
+void zygote_loop(int sock) {
+    int burst, unused;
+    spawn_mode = SPAWN_CLONE;
+    while (recv_int_fd(sock, &burst, &unused) == 0) {
+        int pidfd = -1;
+        pid_t pid = spawn_jobprog(burst, -1, CLONE_PARENT, &pidfd);
+        send_int_fd(sock, pid > 0 ? pid : -errno, pidfd);
+        if (pidfd >= 0) close(pidfd);
+    }
+    _exit(0);
+}
 
-typedef struct job {
-    int id;
-    int arrival;
-    int total_cpu;
-    int remaining;
+void zygote_start() {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) < 0) {
+        perror("socketpair");
+        exit(1);
+    }
+    zygote_pid = fork();
+    if (zygote_pid < 0) { perror("fork zygote"); exit(1); }
+    if (zygote_pid == 0) {
+        close(sv[0]);
+        zygote_loop(sv[1]);
+    }
+    close(sv[1]);
+    zygote_sock = sv[0];
+}
+
+pid_t zygote_spawn(int burst, int *pidfd) {
+    int pid;
+    if (send_int_fd(zygote_sock, burst, -1) < 0 ||
+        recv_int_fd(zygote_sock, &pid, pidfd) < 0) {
+        fprintf(stderr, "zygote: lost connection\n");
+        return -1;
+    }
+    if (pid < 0) { errno = -pid; return -1; }
+    return pid;
+}
+
+void zygote_stop() {
+    if (zygote_sock < 0) return;
+    close(zygote_sock);
+    waitpid(zygote_pid, NULL, 0);
+    zygote_sock = -1;
+}
+
+/* ---------------- CGROUP FREEZER ---------------- */
+/* --preempt=cgroup puts every job in its own cgroup v2 leaf under
+   <our cgroup>/rr-dispatcher.<pid>/ and suspends/resumes it by writing
+   cgroup.freeze, then waits on cgroup.events until the kernel confirms
+   "frozen 1" / "frozen 0". Unlike SIGTSTP this cannot be caught or
+   ignored and also stops any grandchildren. If cgroupfs is not writable
+   we fall back to signals; a job whose leaf cannot be set up uses
+   signals on its own. --preempt=signal (default) confirms each stop with
+   waitid(WSTOPPED), so both backends report comparable latencies. */
+
+typedef enum { PREEMPT_SIGNAL, PREEMPT_CGROUP } preempt_mode_t;
+static preempt_mode_t preempt_mode = PREEMPT_SIGNAL;
+static char cg_base[PATH_MAX];
+static int cg_base_fd = -1;
+
+static latency_t stop_latency, cont_latency, freeze_latency, thaw_latency;
+
+/* Mount point of the cgroup2 hierarchy (pure or hybrid layout) */
+int cgroup2_mount(char *out, size_t len) {
+    FILE *f = fopen("/proc/self/mountinfo", "r");
+    if (!f) return -1;
+    char line[1024];
+    int found = -1;
+    while (found < 0 && fgets(line, sizeof(line), f)) {
+        char mnt[PATH_MAX];
+        char *sep = strstr(line, " - ");
+        if (!sep || strncmp(sep + 3, "cgroup2 ", 8) != 0) continue;
+        if (sscanf(line, "%*d %*d %*s %*s %4095s", mnt) == 1) {
+            snprintf(out, len, "%s", mnt);
+            found = 0;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+/* Our own cgroup v2 path, from the "0::" line of /proc/self/cgroup */
+int cgroup_self(char *out, size_t len) {
+    FILE *f = fopen("/proc/self/cgroup", "r");
+    if (!f) return -1;
+    char line[PATH_MAX];
+    int found = -1;
+    while (found < 0 && fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "0::", 3) != 0) continue;
+        line[strcspn(line, "\n")] = '\0';
+        snprintf(out, len, "%s", strcmp(line + 3, "/") == 0 ? "" : line + 3);
+        found = 0;
+    }
+    fclose(f);
+    return found;
+}
+
+int cg_write(int dirfd, const char *file, const char *val) {
+    int fd = openat(dirfd, file, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = write(fd, val, strlen(val));
+    close(fd);
+    return n == (ssize_t)strlen(val) ? 0 : -1;
+}
+
+void cgroup_init() {
+    if (simulate || preempt_mode != PREEMPT_CGROUP) return;
+
+    char mnt[PATH_MAX], self[PATH_MAX];
+    if (cgroup2_mount(mnt, sizeof(mnt)) == 0 && cgroup_self(self, sizeof(self)) == 0) {
+        int n = snprintf(cg_base, sizeof(cg_base), "%s%s/rr-dispatcher.%d", mnt, self, (int)getpid());
+        if (n < (int)sizeof(cg_base) && mkdir(cg_base, 0755) == 0) {
+            cg_base_fd = open(cg_base, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (cg_base_fd >= 0) return;
+            rmdir(cg_base);
+        }
+    }
+    perror("cgroup v2");
+    fprintf(stderr, "warning: cgroupfs not writable, falling back to --preempt=signal\n");
+    preempt_mode = PREEMPT_SIGNAL;
+}
+
+/* Move the job's process into a fresh leaf "job-<id>". On any failure the
+   job silently keeps using signals. */
+void cgroup_attach(job_t *job) {
+    if (simulate || preempt_mode != PREEMPT_CGROUP) return;
+
+    char name[32], pid[32];
+    snprintf(name, sizeof(name), "job-%d", job->id);
+    snprintf(pid, sizeof(pid), "%d", (int)job->pid);
+    if (mkdirat(cg_base_fd, name, 0755) < 0 && errno != EEXIST) return;
+
+    job->cg_fd = openat(cg_base_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (job->cg_fd >= 0) job->cg_events_fd = openat(job->cg_fd, "cgroup.events", O_RDONLY | O_CLOEXEC);
+    if (job->cg_events_fd < 0 || cg_write(job->cg_fd, "cgroup.procs", pid) < 0) {
+        if (job->cg_events_fd >= 0) close(job->cg_events_fd);
+        if (job->cg_fd >= 0) close(job->cg_fd);
+        job->cg_fd = job->cg_events_fd = -1;
+        unlinkat(cg_base_fd, name, AT_REMOVEDIR);
+    }
+}
+
+/* Drop the job's leaf. A live pool worker is first moved back to the base. */
+void cgroup_detach(job_t *job, int move_back) {
+    if (job->cg_fd < 0) return;
+    if (move_back) {
+        char pid[32];
+        snprintf(pid, sizeof(pid), "%d", (int)job->pid);
+        cg_write(cg_base_fd, "cgroup.procs", pid);
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "job-%d", job->id);
+    close(job->cg_events_fd);
+    close(job->cg_fd);
+    job->cg_fd = job->cg_events_fd = -1;
+    unlinkat(cg_base_fd, name, AT_REMOVEDIR);
+}
+
+/* Wait until cgroup.events reports "frozen <want>". cgroup.events raises
+   POLLPRI on every change. Returns 0 on success, -1 on timeout. */
+int cgroup_wait_frozen(job_t *job, int want) {
+    int64_t deadline = now_ns() + READY_TIMEOUT_MS * 1000000LL;
+    for (;;) {
+        char buf[256];
+        ssize_t n = pread(job->cg_events_fd, buf, sizeof(buf) - 1, 0);
+        if (n > 0) {
+            buf[n] = '\0';
+            char *f = strstr(buf, "frozen ");
+            if (f && atoi(f + 7) == want) return 0;
+        }
+        int64_t left = deadline - now_ns();
+        if (left <= 0) break;
+        struct pollfd pfd = { job->cg_events_fd, POLLPRI, 0 };
+        if (poll(&pfd, 1, (int)((left + 999999) / 1000000)) < 0 && errno != EINTR) break;
+    }
+    fprintf(stderr, "warning: job %d not %s within %d ms\n",
+            job->id, want ? "frozen" : "thawed", READY_TIMEOUT_MS);
+    return -1;
+}
+
+int cgroup_freeze(job_t *job, int frozen) {
+    if (cg_write(job->cg_fd, "cgroup.freeze", frozen ? "1" : "0") < 0) return -1;
+    return cgroup_wait_frozen(job, frozen);
+}
+
+void cgroup_shutdown() {
+    if (cg_base_fd < 0) return;
+    close(cg_base_fd);
+    cg_base_fd = -1;
+    if (rmdir(cg_base) < 0) perror("rmdir cgroup");
+}
+
+void job_signal(job_t *job, int sig);
+
+/* Poll until the kernel reports the job stopped, for at most `ms`.
+   WNOWAIT first, so an exit is left for the event loop to reap. Returns
+   0 = stopped, -1 = exited, 1 = timed out. */
+int wait_stopped(job_t *job, int ms) {
+    idtype_t type = job->pidfd >= 0 ? P_PIDFD : P_PID;
+    id_t id = job->pidfd >= 0 ? (id_t)job->pidfd : (id_t)job->pid;
+    int64_t deadline = now_ns() + ms * 1000000LL;
+    long pause_ns = 20000;
+    for (;;) {
+        siginfo_t si;
+        memset(&si, 0, sizeof(si));
+        if (waitid(type, id, &si, WSTOPPED | WEXITED | WNOHANG | WNOWAIT) < 0) return -1;
+        if (si.si_pid != 0) {
+            if (si.si_code != CLD_STOPPED) return -1;
+            waitid(type, id, &si, WSTOPPED | WNOHANG);  /* consume the report */
+            return 0;
+        }
+        if (now_ns() >= deadline) return 1;
+        struct timespec ts = { 0, pause_ns };
+        nanosleep(&ts, NULL);
+        if (pause_ns < 1000000) pause_ns *= 2;
+    }
+}
+
+/* Confirm the SIGTSTP took. A job that catches or ignores it gets
+   SIGSTOP, which it cannot; only the plain SIGTSTP path returns 0, so
+   the escalation stays out of the SIGTSTP latency figures. */
+int confirm_stopped(job_t *job) {
+    int r = wait_stopped(job, READY_TIMEOUT_MS);
+    if (r <= 0) return r;
+    fprintf(stderr, "warning: job pid=%d ignored SIGTSTP for %d ms, sending SIGSTOP\n",
+            job->pid, READY_TIMEOUT_MS);
+    job_signal(job, SIGSTOP);
+    if (wait_stopped(job, READY_TIMEOUT_MS) > 0)
+        fprintf(stderr, "warning: job pid=%d did not stop\n", job->pid);
+    return -1;
+}
+
+void event_watch(job_t *job);
+void event_unwatch(job_t *job);
+void online_pump(int timeout_ms, int now);
+static long online_events;          /* jobs merged in, or the input ended */
+
+/* ---------------- WARM POOL ---------------- */
+/* --pool N: N jobprog workers started up front and parked on a command
+   pipe. Starting a job hands it to an idle worker with one JOB_CMD_RUN
+   message; on FINISH the worker gets JOB_CMD_END and returns to the pool
+   instead of exiting. When every worker is busy we spawn as usual. */
+
+typedef struct {
     pid_t pid;
-    state_t state;
-    struct job *next;
-} job_t;
+    int pidfd;
+    int cmd_fd;         /* write end of the worker's command pipe */
+    int busy;
+    int dead;           /* died, busy or idle; never handed work again */
+} worker_t;
 
-static job_t *rr_head = NULL, *rr_tail = NULL;
-static job_t *input_head = NULL;
+static worker_t *pool = NULL;
+static int pool_size = 0;
+static latency_t pool_latency;
 
-#define MAX_TIME 2000
-int gantt[MAX_TIME];
-int gantt_index = 0;
+void pool_init() {
+    if (simulate || pool_size <= 0) return;
+    pool = calloc(pool_size, sizeof(worker_t));
+    for (int i = 0; i < pool_size; i++) {
+        int cmd[2];
+        if (pipe2(cmd, O_CLOEXEC) < 0) { perror("pipe2"); exit(1); }
+        pool[i].pid = spawn_jobprog(0, cmd[0], 0, &pool[i].pidfd);
+        if (pool[i].pid < 0) { perror("spawn worker"); exit(1); }
+        close(cmd[0]);
+        pool[i].cmd_fd = cmd[1];
+    }
+}
 
-/* ---------------- QUEUE FUNCTIONS ---------------- */
+int pool_send(worker_t *w, int kind, int burst) {
+    struct job_cmd cmd = { kind, burst };
+    return write(w->cmd_fd, &cmd, sizeof(cmd)) == sizeof(cmd) ? 0 : -1;
+}
 
-void enqueue_rr(job_t *j) {
-    j->next = NULL;
-    if (!rr_tail) rr_head = rr_tail = j;
-    else { rr_tail->next = j; rr_tail = j; }
+/* An idle worker's command pipe broke: nobody watches idle workers, so
+   this is where its death shows. Reap it and stop offering it work. */
+void pool_retire(worker_t *w) {
+    fprintf(stderr, "warning: pool worker pid=%d is gone, retiring it\n", w->pid);
+    kill(w->pid, SIGKILL);
+    waitpid(w->pid, NULL, 0);
+    if (w->pidfd >= 0) close(w->pidfd);
+    w->pidfd = -1;
+    w->dead = 1;
 }
 
-job_t *dequeue_rr() {
-    job_t *j = rr_head;
-    if (!j) return NULL;
-    rr_head = rr_head->next;
-    if (!rr_head) rr_tail = NULL;
-    j->next = NULL;
-    return j;
+/* Hand `job` to an idle worker. Returns 0, or -1 if none is free. */
+int pool_start(job_t *job) {
+    for (int i = 0; i < pool_size; i++) {
+        worker_t *w = &pool[i];
+        if (w->busy || w->dead) continue;
+        int64_t t0 = now_ns();
+        if (pool_send(w, JOB_CMD_RUN, job->total_cpu) < 0) {
+            pool_retire(w);
+            continue;
+        }
+        if (wait_ready(w->pid, w->pidfd, JOB_READY) == 0) latency_add(&pool_latency, now_ns() - t0);
+        w->busy = 1;
+        job->worker = i;
+        job->pid = w->pid;
+        job->pidfd = w->pidfd;
+        event_watch(job);
+        return 0;
+    }
+    return -1;
 }
 
-job_t *pop_input_if_arrival_le(int t) {
-    if (!input_head) return NULL;
-    if (input_head->arrival <= t) {
-        job_t *j = input_head;
-        input_head = input_head->next;
-        j->next = NULL;
-        return j;
+/* The job is done: park its worker again */
+void pool_release(job_t *job) {
+    worker_t *w = &pool[job->worker];
+    event_unwatch(job);
+    cgroup_detach(job, 1);
+    pool_send(w, JOB_CMD_END, 0);
+    wait_ready(w->pid, w->pidfd, JOB_IDLE);
+    w->busy = 0;
+    job->worker = -1;
+    job->pidfd = -1;
+}
+
+/* Closing the command pipes makes every worker exit */
+void pool_shutdown() {
+    for (int i = 0; i < pool_size && pool; i++) {
+        close(pool[i].cmd_fd);
+        if (pool[i].dead) continue;
+        waitpid(pool[i].pid, NULL, 0);
+        if (pool[i].pidfd >= 0) close(pool[i].pidfd);
     }
-    return NULL;
+    free(pool);
+    pool = NULL;
 }
 
-void move_arrivals_to_rr(int t) {
-    job_t *m;
-    while ((m = pop_input_if_arrival_le(t)) != NULL) {
-        printf("[t=%d] ➤ Job %d ARRIVED (burst=%d)\n", t, m->id, m->total_cpu);
-        enqueue_rr(m);
+/* ---------------- EVENT LOOP ---------------- */
+/* Real mode waits in one epoll set watching the tick timerfd, a signalfd
+   for SIGCHLD and the pidfd of every live job. Reaping after FINISH and
+   noticing a job that died on its own are both events handled here, so
+   nothing on the dispatch path blocks in waitpid(). */
+
+static int epoll_fd = -1;
+static int sigchld_fd = -1;
+static int live_jobs = 0;       /* watched and not yet reaped or released */
+
+/* Jobs without a pidfd (no kernel support) are found through SIGCHLD */
+static job_t **pidless = NULL;
+static int pidless_count = 0, pidless_cap = 0;
+
+/* Jobs that died on their own, handed to the main loop to retire */
+static job_t **crashed = NULL;
+static int crashed_count = 0, crashed_cap = 0;
+
+void job_list_push(job_t ***list, int *count, int *cap, job_t *j) {
+    if (*count == *cap) {
+        *cap = *cap ? *cap * 2 : 16;
+        *list = realloc(*list, *cap * sizeof(job_t *));
+        if (!*list) { perror("realloc"); exit(1); }
     }
+    (*list)[(*count)++] = j;
 }
 
-int any_jobs_left() {
-    return (input_head != NULL) || (rr_head != NULL);
+void event_add(int fd, void *ptr) {
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = ptr };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) { perror("epoll_ctl"); exit(1); }
 }
 
-/* ---------------- CSV LOADING ---------------- */
-void load_jobs(const char *fname) {
-    FILE *f = fopen(fname, "r");
-    if (!f) { perror("fopen"); exit(1); }
+void event_loop_init() {
+    if (simulate) return;
 
-    char line[256];
-    job_t *last = NULL;
-    int job_counter = 1; 
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGPIPE);  /* a dead pool worker must not kill us */
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    sigdelset(&mask, SIGPIPE);
+    sigchld_fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (sigchld_fd < 0) { perror("signalfd"); exit(1); }
 
-    while (fgets(line, sizeof(line), f)) {
-        if (line[0]=='#' || strlen(line)<3) continue;
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) { perror("epoll_create1"); exit(1); }
+    event_add(tick_fd, &tick_fd);
+    event_add(sigchld_fd, &sigchld_fd);
+}
 
-        int arrival, priority, service, memory, p4, p5, p6, p7;
-        int parsed = sscanf(line, "%d,%d,%d,%d,%d,%d,%d,%d", 
-                           &arrival, &priority, &service, &memory, &p4, &p5, &p6, &p7);
-        
-        if (parsed >= 3) { 
-            job_t *j = calloc(1, sizeof(job_t));
-            j->id = job_counter++;
-            j->arrival = arrival;
-            j->total_cpu = service;
-            j->remaining = service;
-            j->pid = -1;
-            j->state = NOT_STARTED;
-            j->next = NULL;
-
-            if (!input_head) input_head = last = j;
-            else { last->next = j; last = j; }
+/* Start watching a job's process for exit */
+void event_watch(job_t *job) {
+    if (simulate) return;
+    live_jobs++;
+    if (job->pidfd >= 0) event_add(job->pidfd, job);
+    else job_list_push(&pidless, &pidless_count, &pidless_cap, job);
+}
+
+/* Stop watching without a reap (pool worker handed back) */
+void event_unwatch(job_t *job) {
+    if (simulate) return;
+    live_jobs--;
+    if (job->pidfd >= 0) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, job->pidfd, NULL);
+}
+
+/* The job's process is gone: reap it, then either finish the FINISH we
+   started or report a crash */
+void child_exited(job_t *job) {
+    if (job->pidfd >= 0) {
+        siginfo_t si;
+        memset(&si, 0, sizeof(si));
+        waitid(P_PIDFD, job->pidfd, &si, WEXITED | WNOHANG);
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, job->pidfd, NULL);
+    }
+    live_jobs--;
+
+    cgroup_detach(job, 0);
+    if (job->state == TERMINATED) {
+        if (job->pidfd >= 0) close(job->pidfd);
+        return;
+    }
+
+    if (job->worker >= 0) {
+        pool[job->worker].dead = 1;
+        pool[job->worker].pidfd = -1;
+    }
+    if (job->pidfd >= 0) close(job->pidfd);
+    job->pidfd = -1;
+    job->state = CRASHED;
+    job_list_push(&crashed, &crashed_count, &crashed_cap, job);
+}
+
+void reap_pidless() {
+    struct signalfd_siginfo ssi;
+    while (read(sigchld_fd, &ssi, sizeof(ssi)) == sizeof(ssi))
+        ;
+    for (int i = 0; i < pidless_count; i++) {
+        job_t *job = pidless[i];
+        if (waitpid(job->pid, NULL, WNOHANG) != job->pid) continue;
+        pidless[i--] = pidless[--pidless_count];
+        child_exited(job);
+    }
+}
+
+/* Handle one batch of events. Returns the number of events, and sets
+   *tick_fired when the tick timer expired. */
+int event_poll(int timeout_ms, int *tick_fired) {
+    struct epoll_event ev[32];
+    int n = epoll_wait(epoll_fd, ev, 32, timeout_ms);
+    if (n < 0) {
+        if (errno == EINTR) return 0;
+        perror("epoll_wait");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        if (ev[i].data.ptr == &tick_fd) {
+            uint64_t expirations;
+            if (read(tick_fd, &expirations, sizeof(expirations)) > 0) *tick_fired = 1;
+        } else if (ev[i].data.ptr == &sigchld_fd) {
+            reap_pidless();
+        } else if (ev[i].data.ptr == &online_events) {
+            online_pump(0, (int)((now_ns() - ts_to_ns(&tick_origin)) / tick_ns) + 1);
         } else {
-            int arrival2, id, service2;
-            if (sscanf(line, "%d,%d,%d", &arrival2, &id, &service2) == 3) {
-                job_t *j = calloc(1, sizeof(job_t));
-                j->id = id;
-                j->arrival = arrival2;
-                j->total_cpu = service2;
-                j->remaining = service2;
-                j->pid = -1;
-                j->state = NOT_STARTED;
-                j->next = NULL;
-
-                if (!input_head) input_head = last = j;
-                else { last->next = j; last = j; }
-            }
+            child_exited(ev[i].data.ptr);
         }
     }
-    fclose(f);
+    return n;
 }
 
-/* ---------------- PRINT FUNCTIONS ---------------- */
-void print_job_table() {
-    printf("\n==================== JOB TABLE ====================\n");
-    printf(" Job ID | Arrival | CPU Burst \n");
-    printf("--------+---------+-----------\n");
+void arm_tick(int t) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value = ns_to_ts(ts_to_ns(&tick_origin) + (int64_t)t * tick_ns);
+    if (timerfd_settime(tick_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+        perror("timerfd_settime");
+        exit(1);
+    }
+}
 
-    job_t *p = input_head;
-    while (p) {
-        printf("   %-4d |   %-5d |    %-5d\n", p->id, p->arrival, p->total_cpu);
-        p = p->next;
+/* Block until tick `t` begins, handling child events meanwhile. One timed
+   wait covers any number of ticks; an already-expired deadline returns
+   immediately. If a job crashes or an --online job comes in during a
+   multi-tick wait, the wait is cut short at the end of the tick in
+   progress. Returns the tick reached.
+   (Virtual clock: nothing to wait for.) */
+int wait_until_tick(int t) {
+    if (simulate) return t;
+
+    arm_tick(t);
+    int seen = crashed_count;
+    long seen_online = online_events;
+    int fired = 0;
+    while (!fired) {
+        event_poll(-1, &fired);
+        if (!fired && (crashed_count > seen || online_events > seen_online)) {
+            int k = (int)((now_ns() - ts_to_ns(&tick_origin)) / tick_ns) + 1;
+            if (k < t) { t = k; arm_tick(t); }
+            seen = crashed_count;
+            seen_online = online_events;
+        }
     }
-    printf("===================================================\n\n");
+    return t;
 }
 
-void print_gantt_chart() {
-    printf("\n==================== GANTT CHART ====================\n");
-    printf("Time:  ");
-    // Print up to gantt_index, which is now the correct length
-    for (int i = 0; i < gantt_index; i++) printf("%-4d", i);
+/* After the last tick: collect every job still exiting */
+void event_drain() {
+    if (simulate) return;
+    int unused;
+    while (live_jobs > 0) {
+        if (event_poll(READY_TIMEOUT_MS, &unused) == 0) {
+            fprintf(stderr, "warning: %d job(s) still not reaped\n", live_jobs);
+            break;
+        }
+    }
+}
+
+/* Signal a job through its pidfd, immune to pid reuse */
+void job_signal(job_t *job, int sig) {
+    if (job->pidfd >= 0) sys_pidfd_send_signal(job->pidfd, sig);
+    else kill(job->pid, sig);
+}
 
-    printf("\nCPU:   ");
-    for (int i = 0; i < gantt_index; i++) {
-        if (gantt[i] == -1) printf(" -  ");
-        else printf("J%-2d ", gantt[i]);
+/* Pin the job's process to its core's host CPU (multi-CPU mode only) */
+void job_pin(job_t *job) {
+    if (simulate || ncpus == 1 || job->pinned_cpu == job->cpu) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[job->cpu].core, &set);
+    if (sched_setaffinity(job->pid, sizeof(set), &set) == 0) job->pinned_cpu = job->cpu;
+}
+
+void job_start(job_t *job, int t) {
+    pid_t pid = 0;
+    if (!simulate && pool_start(job) == 0) {
+        pid = job->pid;
+    } else if (!simulate) {
+        int64_t t0 = now_ns();
+        if (spawn_mode == SPAWN_ZYGOTE) pid = zygote_spawn(job->total_cpu, &job->pidfd);
+        else pid = spawn_jobprog(job->total_cpu, -1, 0, &job->pidfd);
+        if (pid < 0) { perror("spawn"); exit(1); }
+        latency_add(&spawn_latency, now_ns() - t0);
+        event_watch(job);
+        if (wait_ready(pid, job->pidfd, JOB_READY) == 0) latency_add(&start_latency, now_ns() - t0);
     }
+    job->pid = pid;
+    job->state = RUNNING;
+    if (!simulate) {
+        cgroup_attach(job);
+        job_pin(job);
+    }
+    TRACE("[t=%d] ▶ START Job %d (pid=%d)%s\n", t, job->id, pid, cpu_tag(job->cpu));
+}
 
-    printf("\n\nExpected (Stallings Fig 9.5):\n");
-    printf("CPU:   J1  J1  J2  J1  J2  J3  J2  J4  J3  J2  J5  J4  J3  J2  J5  J4  J3  J2  J4  J4\n");
-    printf("=====================================================\n\n");
+void job_suspend(job_t *job, int t) {
+    if (!simulate) {
+        int64_t t0 = now_ns();
+        if (job->cg_fd >= 0) {
+            if (cgroup_freeze(job, 1) == 0) latency_add(&freeze_latency, now_ns() - t0);
+        } else {
+            job_signal(job, SIGTSTP);
+            if (confirm_stopped(job) == 0) latency_add(&stop_latency, now_ns() - t0);
+        }
+    }
+    job->state = SUSPENDED;
+    TRACE("[t=%d] ⏸ PREEMPT Job %d%s\n", t, job->id, cpu_tag(job->cpu));
 }
 
-void print_statistics(int completion[], int arrivals[], int bursts[], int n) {
-    printf("==================== STATISTICS ====================\n");
-    printf(" Job ID | Arrival | Burst | Completion | Turnaround | Waiting\n");
-    printf("--------+---------+-------+------------+------------+---------\n");
-    
-    float total_ta = 0, total_wt = 0;
-    
-    for (int i = 0; i < n; i++) {
-        int ta = completion[i] - arrivals[i];
-        int wt = ta - bursts[i];
-        total_ta += ta;
-        total_wt += wt;
-        
-        printf("   %-4d |   %-5d |  %-4d |    %-7d |    %-7d |   %-5d\n",
-               i+1, arrivals[i], bursts[i], completion[i], ta, wt);
+void job_resume(job_t *job, int t) {
+    if (!simulate) {
+        job_pin(job);   /* may have been stolen by another core */
+        int64_t t0 = now_ns();
+        if (job->cg_fd >= 0) {
+            if (cgroup_freeze(job, 0) == 0) latency_add(&thaw_latency, now_ns() - t0);
+        } else {
+            job_signal(job, SIGCONT);
+            if (wait_ready(job->pid, job->pidfd, JOB_RESUMED) == 0) latency_add(&cont_latency, now_ns() - t0);
+        }
     }
-    
-    printf("----------------------------------------------------\n");
-    printf("Average Turnaround Time: %.2f\n", total_ta / n);
-    printf("Average Waiting Time: %.2f\n", total_wt / n);
-    printf("====================================================\n");
+    job->state = RUNNING;
+    TRACE("[t=%d] ▶ RESUME Job %d (pid=%d)%s\n", t, job->id, job->pid, cpu_tag(job->cpu));
+}
+
+/* Ends the job and releases its process: now, or in child_exited() once
+   the process has been reaped. The caller must not touch `job`
+   afterwards. */
+void job_terminate(job_t *job, int t) {
+    job->state = TERMINATED;
+    TRACE("[t=%d] ✔ FINISH Job %d%s\n", t, job->id, cpu_tag(job->cpu));
+    if (!simulate && job->worker < 0) {
+        job_signal(job, SIGINT);
+        return;
+    }
+    if (!simulate) pool_release(job);
+}
+
+void print_latency_row(const char *name, const latency_t *l) {
+    if (l->count == 0) printf(" %-8s |      0 |        -   |        -\n", name);
+    else printf(" %-8s | %6ld | %10.1f | %10.1f\n", name, l->count,
+                l->total_ns / 1e3 / l->count, l->max_ns / 1e3);
+}
+
+void print_dispatch_overhead() {
+    printf("\n================ DISPATCH OVERHEAD (µs) ================\n");
+    printf(" Event    |  Count |    Average |        Max\n");
+    printf("----------+--------+------------+-----------\n");
+    print_latency_row("SPAWN", &spawn_latency);
+    print_latency_row("START", &start_latency);
+    print_latency_row("POOLED", &pool_latency);
+    printf("========================================================\n");
+}
+
+/* Both preemption backends side by side: run once per --preempt mode (or
+   let cgroup fall back per job) to compare them on the same trace */
+void print_preemption_latency() {
+    printf("\n=============== PREEMPTION LATENCY (µs) ================\n");
+    printf(" Event    |  Count |    Average |        Max\n");
+    printf("----------+--------+------------+-----------\n");
+    print_latency_row("SIGTSTP", &stop_latency);
+    print_latency_row("SIGCONT", &cont_latency);
+    print_latency_row("FREEZE", &freeze_latency);
+    print_latency_row("THAW", &thaw_latency);
+    printf("========================================================\n");
+}
+
+/* ---------------- ONLINE ARRIVALS ---------------- */
+/* --online SRC keeps taking jobs while the dispatcher runs, as CSV lines
+   in the trace format, from
+       -           standard input
+       PATH        a named FIFO (a plain file is read once)
+       unix:PATH   a Unix stream socket listening at PATH; any number of
+                   producers may connect
+       tail:PATH   a file followed with inotify as lines are appended,
+                   from its first line
+   A trace given as well is loaded first and online jobs number on from it.
+
+   Every descriptor is non-blocking and sits in one epoll set of its own,
+   which real mode watches from the event loop. The complete lines that
+   have come in go through csv_parse_chunk() into one block of jobs, and
+   each job is merged into the input list by arrival. A job stamped
+   earlier than now arrives now: at the next tick in real mode, at the
+   current one under --simulate. The virtual clock only moves on once the
+   input has shown a later arrival or ended, so piping a sorted trace in
+   replays it exactly.
+
+   The input ends at EOF on stdin or a plain file. With --drain it also
+   ends when the FIFO's last writer closes, when the last producer on the
+   socket disconnects, or when the followed file is removed or renamed;
+   without it those sources wait for more. Once the input has ended, the
+   run finishes the jobs it has and exits as usual. */
+
+#define ONLINE_BATCH (1 << 20)      /* parse at least this often while reading */
+#define ONLINE_IDLE_TICKS (1 << 20) /* idle wait with nothing known to come */
+
+typedef enum { SRC_STREAM, SRC_FIFO, SRC_LISTEN, SRC_CLIENT, SRC_TAIL, SRC_INOTIFY } src_kind_t;
+
+typedef struct {
+    int fd;
+    src_kind_t kind;
+    char *buf;                      /* bytes past the last complete line */
+    size_t len, cap;
+} online_src_t;
+
+static const char *online_spec = NULL;  /* --online */
+static int online_drain = 0;            /* --drain */
+static const char *online_path = NULL;  /* FIFO, socket or followed file */
+static int online_epfd = -1;
+static online_src_t **online_srcs;
+static int online_nsrcs, online_srcs_cap;
+static online_src_t *online_tail;       /* tail:, the file itself */
+static int online_clients = 0;
+static int online_next_idx = 0;
+static int online_chunks_cap = 0;
+static int stdin_flags = -1;            /* to restore at the end */
+
+/* Keep the input list in arrival order; online jobs usually go last */
+void input_insert(job_t *j) {
+    j->next = NULL;
+    if (!input_head) {
+        input_head = input_tail = j;
+    } else if (j->arrival >= input_tail->arrival) {
+        input_tail->next = j;
+        input_tail = j;
+    } else if (j->arrival < input_head->arrival) {
+        j->next = input_head;
+        input_head = j;
+    } else {
+        job_t *p = input_head;
+        while (p->next->arrival <= j->arrival) p = p->next;
+        j->next = p->next;
+        p->next = j;
+    }
+}
+
+void online_add(int fd, src_kind_t kind) {
+    online_src_t *s = calloc(1, sizeof(online_src_t));
+    if (!s) { perror("calloc"); exit(1); }
+    s->fd = fd;
+    s->kind = kind;
+    if (kind != SRC_TAIL) {
+        int fl = fcntl(fd, F_GETFL);
+        if (fd == STDIN_FILENO) stdin_flags = fl;
+        fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = s };
+        if (epoll_ctl(online_epfd, EPOLL_CTL_ADD, fd, &ev) < 0) { perror("epoll_ctl"); exit(1); }
+    }
+    if (online_nsrcs == online_srcs_cap) {
+        online_srcs_cap = online_srcs_cap ? online_srcs_cap * 2 : 8;
+        online_srcs = realloc(online_srcs, online_srcs_cap * sizeof(online_src_t *));
+        if (!online_srcs) { perror("realloc"); exit(1); }
+    }
+    online_srcs[online_nsrcs++] = s;
+    if (kind == SRC_TAIL) online_tail = s;
+}
+
+void online_remove(online_src_t *s) {
+    if (s->kind != SRC_TAIL) epoll_ctl(online_epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    if (s->fd == STDIN_FILENO) fcntl(s->fd, F_SETFL, stdin_flags);
+    else close(s->fd);
+    for (int i = 0; i < online_nsrcs; i++)
+        if (online_srcs[i] == s) online_srcs[i] = online_srcs[--online_nsrcs];
+    if (s == online_tail) online_tail = NULL;
+    free(s->buf);
+    free(s);
+}
+
+/* No more input: every source closes */
+void online_end() {
+    while (online_nsrcs) online_remove(online_srcs[online_nsrcs - 1]);
+    if (epoll_fd >= 0) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, online_epfd, NULL);
+    close(online_epfd);
+    online_epfd = -1;
+    if (online_spec && strncmp(online_spec, "unix:", 5) == 0) unlink(online_path);
+    free(online_srcs);
+    online_srcs = NULL;
+    online_srcs_cap = 0;
+    online_live = 0;
+    online_events++;
+}
+
+/* Parse the complete lines in the buffer (all of it at `eof`) into a new
+   job block and merge the jobs in, none earlier than `now` */
+void online_lines(online_src_t *s, int now, int eof) {
+    size_t n = s->len;
+    if (!eof) {
+        const char *nl = memrchr(s->buf, '\n', s->len);
+        if (!nl) return;
+        n = nl - s->buf + 1;
+    }
+    if (n == 0) return;
+
+    if (csv_nchunks == online_chunks_cap) {
+        online_chunks_cap = online_chunks_cap ? online_chunks_cap * 2 : csv_nchunks + 16;
+        csv_chunks = realloc(csv_chunks, online_chunks_cap * sizeof(csv_chunk_t));
+        if (!csv_chunks) { perror("realloc"); exit(1); }
+    }
+    csv_chunk_t *c = &csv_chunks[csv_nchunks];
+    memset(c, 0, sizeof(*c));
+    c->data = s->buf;
+    c->size = c->end = n;
+    csv_parse_chunk(c);
+    c->data = NULL;
+
+    if (c->count) {
+        csv_nchunks++;
+        for (int i = 0; i < c->count; i++) {
+            job_t *j = &c->jobs[i];
+            j->idx = online_next_idx++;
+            j->id = j->idx + 1;
+            if (j->arrival < now) j->arrival = now;
+            input_insert(j);
+        }
+        online_events++;
+    } else {
+        free(c->jobs);
+    }
+    memmove(s->buf, s->buf + n, s->len - n);
+    s->len -= n;
+}
+
+/* Read what is there, parsing complete lines as they come. Returns 1 at
+   EOF; the partial last line is left for the caller. */
+int online_read(online_src_t *s, int now) {
+    for (;;) {
+        if (s->cap - s->len < 4096) {
+            s->cap = s->cap ? s->cap * 2 : 65536;
+            s->buf = realloc(s->buf, s->cap);
+            if (!s->buf) { perror("realloc"); exit(1); }
+        }
+        ssize_t r = read(s->fd, s->buf + s->len, s->cap - s->len);
+        if (r > 0) {
+            s->len += r;
+            if (s->len >= ONLINE_BATCH) online_lines(s, now, 0);
+            continue;
+        }
+        if (r < 0 && errno == EINTR) continue;
+        int eof = r == 0 || errno != EAGAIN;
+        if (r < 0 && eof) perror("read");
+        online_lines(s, now, 0);
+        return eof;
+    }
+}
+
+void online_reopen_fifo(online_src_t *s) {
+    epoll_ctl(online_epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    close(s->fd);
+    s->fd = open(online_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (s->fd < 0) { perror(online_path); exit(1); }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = s };
+    if (epoll_ctl(online_epfd, EPOLL_CTL_ADD, s->fd, &ev) < 0) { perror("epoll_ctl"); exit(1); }
+}
+
+/* tail: the file changed, or went away */
+void online_follow(online_src_t *s, int now) {
+    char ev[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int gone = 0;
+    ssize_t r;
+    while ((r = read(s->fd, ev, sizeof(ev))) > 0) {
+        for (char *p = ev; p < ev + r; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len)
+            if (((struct inotify_event *)p)->mask & (IN_MOVE_SELF | IN_DELETE_SELF)) gone = 1;
+    }
+
+    online_src_t *f = online_tail;
+    struct stat st;
+    if (fstat(f->fd, &st) == 0) {
+        if (st.st_nlink == 0) gone = 1;
+        if (st.st_size < lseek(f->fd, 0, SEEK_CUR)) {   /* truncated: start over */
+            lseek(f->fd, 0, SEEK_SET);
+            f->len = 0;
+        }
+    }
+    online_read(f, now);
+    if (gone && online_drain) {
+        online_lines(f, now, 1);
+        online_end();
+    }
+}
+
+/* Handle whatever the sources have, waiting up to timeout_ms for it */
+void online_pump(int timeout_ms, int now) {
+    if (!online_live) return;
+    struct epoll_event ev[32];
+    int n = epoll_wait(online_epfd, ev, 32, timeout_ms);
+    if (n < 0 && errno != EINTR) { perror("epoll_wait"); exit(1); }
+    for (int i = 0; i < n && online_live; i++) {
+        online_src_t *s = ev[i].data.ptr;
+        switch (s->kind) {
+        case SRC_LISTEN: {
+            int fd;
+            while ((fd = accept4(s->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                online_add(fd, SRC_CLIENT);
+                online_clients++;
+            }
+            break;
+        }
+        case SRC_INOTIFY:
+            online_follow(s, now);
+            break;
+        default:
+            if (!online_read(s, now)) break;
+            online_lines(s, now, 1);
+            if (s->kind == SRC_CLIENT) {
+                online_remove(s);
+                if (--online_clients == 0 && online_drain) online_end();
+            } else if (s->kind == SRC_FIFO && !online_drain) {
+                online_reopen_fifo(s);
+            } else {
+                online_end();
+            }
+        }
+    }
+}
+
+/* A plain file has no readiness to wait for: take it all now */
+void online_stream(int fd, src_kind_t kind) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        online_src_t s = { .fd = fd };
+        while (!online_read(&s, 0))
+            ;
+        online_lines(&s, 0, 1);
+        free(s.buf);
+        if (fd != STDIN_FILENO) close(fd);
+        online_end();
+        return;
+    }
+    online_add(fd, kind);
+}
+
+void online_start(const char *spec) {
+    online_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (online_epfd < 0) { perror("epoll_create1"); exit(1); }
+    online_live = 1;
+    online_chunks_cap = csv_nchunks;
+    for (int i = 0; i < csv_nchunks; i++) online_next_idx += csv_chunks[i].count;
+    for (job_t *p = input_head; p; p = p->next) input_tail = p;
+
+    if (strcmp(spec, "-") == 0) {
+        online_stream(STDIN_FILENO, SRC_STREAM);
+    } else if (strncmp(spec, "unix:", 5) == 0) {
+        online_path = spec + 5;
+        struct sockaddr_un a = { .sun_family = AF_UNIX };
+        if (strlen(online_path) >= sizeof(a.sun_path)) {
+            fprintf(stderr, "%s: socket path too long\n", online_path);
+            exit(1);
+        }
+        strcpy(a.sun_path, online_path);
+        struct stat st;
+        if (lstat(online_path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(online_path);  /* stale */
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&a, sizeof(a)) < 0 || listen(fd, 64) < 0) {
+            perror(online_path);
+            exit(1);
+        }
+        online_add(fd, SRC_LISTEN);
+    } else if (strncmp(spec, "tail:", 5) == 0) {
+        online_path = spec + 5;
+        int in = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (in < 0) { perror("inotify_init1"); exit(1); }
+        /* Watch first, then read: nothing appended in between is missed */
+        if (inotify_add_watch(in, online_path, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF) < 0) {
+            perror(online_path);
+            exit(1);
+        }
+        int fd = open(online_path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) { perror(online_path); exit(1); }
+        online_add(in, SRC_INOTIFY);
+        online_add(fd, SRC_TAIL);
+        online_read(online_tail, 0);
+    } else {
+        online_path = spec;
+        int fd = open(spec, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) { perror(spec); exit(1); }
+        online_stream(fd, SRC_FIFO);
+    }
+    if (online_live && !simulate) event_add(online_epfd, &online_events);
+}
+
+/* --simulate: before tick t, read until the input shows an arrival after
+   t or ends, so the virtual clock never runs past a job still unread */
+void online_lookahead(int t) {
+    if (!simulate) return;
+    while (online_live && (!input_head || input_tail->arrival <= t))
+        online_pump(-1, t);
 }
 
 /* ---------------- MAIN DISPATCHER ---------------- */
 
+/* Statistics rows for the jobs loaded since the last call: the whole
+   trace at start, then whatever --online brought in */
+job_stat_t *stats_collect(job_stat_t *stats, int *job_count) {
+    static int seen_chunks = 0, cap = 0;
+    for (; seen_chunks < csv_nchunks; seen_chunks++) {
+        csv_chunk_t *c = &csv_chunks[seen_chunks];
+        for (int i = 0; i < c->count; i++) {
+            job_t *p = &c->jobs[i];
+            if (p->idx >= cap) {
+                int old = cap;
+                cap = cap ? cap * 2 : 64;
+                if (cap <= p->idx) cap = p->idx + 1;
+                stats = realloc(stats, cap * sizeof(job_stat_t));
+                if (!stats) { perror("realloc"); exit(1); }
+                memset(stats + old, 0, (cap - old) * sizeof(job_stat_t));
+            }
+            if (p->idx >= *job_count) *job_count = p->idx + 1;
+            stats[p->idx].id = p->id;
+            stats[p->idx].arrival = p->arrival;
+            stats[p->idx].burst = p->total_cpu;
+            stats[p->idx].deadline = p->deadline;
+            stats[p->idx].user = p->user;
+            stats[p->idx].group = p->group;
+        }
+    }
+    return stats;
+}
+
+void usage(const char *prog) {
+    printf("Usage: %s [--simulate] [--quiet] [--quantum US] [--time-scale F] [--spawn clone|fork|zygote] [--pool N] [--preempt signal|cgroup] [--cpus N] [--load-threads N] [--policy P] [--policy-opt S] [--swf] [--swf-tick S] [--swf-status L] [--swf-queue L] [--online SRC [--drain]] jobs.csv|jobs.swf|jobs.rrt\n", prog);
+    printf("       %s --convert in.csv out.rrt\n", prog);
+    printf("  --quantum US     wall-clock length of one tick in microseconds (default 1000000)\n");
+    printf("  --time-scale F   run F times faster than real time (default 1)\n");
+    printf("  --spawn MODE     clone (default, vfork-style + pidfd), fork, or zygote\n");
+    printf("  --pool N         keep N reusable jobprog workers parked for new jobs\n");
+    printf("  --preempt MODE   signal (default, SIGTSTP/SIGCONT) or cgroup (v2 freezer)\n");
+    printf("  --cpus N         N cores with per-core run queues and work stealing\n");
+    printf("  --load-threads N threads parsing the trace (default: one per CPU, max 16)\n");
+    printf("  --policy P       scheduling policy: built-in name (default rr) or path.so\n");
+    printf("  --policy-opt S   option string handed to the policy's init\n");
+    printf("  --convert        write in.csv as a binary columnar trace and exit\n");
+    printf("  --swf            read the trace as SWF (automatic for *.swf)\n");
+    printf("  --swf-tick S     seconds of SWF time per tick (default 1)\n");
+    printf("  --swf-status L   keep SWF jobs with these statuses, e.g. 1,0\n");
+    printf("  --swf-queue L    keep SWF jobs from these queues\n");
+    printf("  --online SRC     also take CSV jobs while running from -, a FIFO,\n");
+    printf("                   unix:PATH or tail:PATH (the trace is then optional)\n");
+    printf("  --drain          end online input at EOF or when producers leave\n");
+    exit(1);
+}
+
 int main(int argc, char **argv) {
-    if (argc < 2) {
-        printf("Usage: %s jobs.csv\n", argv[0]);
-        exit(1);
+    static const struct option opts[] = {
+        { "simulate", no_argument, NULL, 's' },
+        { "quiet",    no_argument, NULL, 'q' },
+        { "quantum",    required_argument, NULL, 'Q' },
+        { "time-scale", required_argument, NULL, 'T' },
+        { "spawn",      required_argument, NULL, 'S' },
+        { "pool",       required_argument, NULL, 'P' },
+        { "preempt",    required_argument, NULL, 'R' },
+        { "cpus",       required_argument, NULL, 'C' },
+        { "load-threads", required_argument, NULL, 'J' },
+        { "policy",     required_argument, NULL, 'L' },
+        { "policy-opt", required_argument, NULL, 'O' },
+        { "convert",    no_argument,       NULL, 'V' },
+        { "swf",        no_argument,       NULL, 'W' },
+        { "swf-tick",   required_argument, NULL, 'K' },
+        { "swf-status", required_argument, NULL, 'U' },
+        { "swf-queue",  required_argument, NULL, 'X' },
+        { "online",     required_argument, NULL, 'N' },
+        { "drain",      no_argument,       NULL, 'D' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c, convert = 0;
+    while ((c = getopt_long(argc, argv, "sq", opts, NULL)) != -1) {
+        switch (c) {
+        case 's': simulate = 1; break;
+        case 'q': quiet = 1; break;
+        case 'Q': quantum_us = atol(optarg); break;
+        case 'T': time_scale = atof(optarg); break;
+        case 'S':
+            if (strcmp(optarg, "clone") == 0) spawn_mode = SPAWN_CLONE;
+            else if (strcmp(optarg, "fork") == 0) spawn_mode = SPAWN_FORK;
+            else if (strcmp(optarg, "zygote") == 0) spawn_mode = SPAWN_ZYGOTE;
+            else usage(argv[0]);
+            break;
+        case 'P': pool_size = atoi(optarg); break;
+        case 'C': ncpus = atoi(optarg); break;
+        case 'J': load_threads = atoi(optarg); break;
+        case 'L': policy_load(optarg); break;
+        case 'O': policy_opts = optarg; break;
+        case 'V': convert = 1; break;
+        case 'W': swf_input = 1; break;
+        case 'K': swf_tick = atof(optarg); break;
+        case 'U': if (!swf_parse_filter(optarg, &swf_status)) usage(argv[0]); break;
+        case 'X': if (!swf_parse_filter(optarg, &swf_queue)) usage(argv[0]); break;
+        case 'N': online_spec = optarg; break;
+        case 'D': online_drain = 1; break;
+        case 'R':
+            if (strcmp(optarg, "signal") == 0) preempt_mode = PREEMPT_SIGNAL;
+            else if (strcmp(optarg, "cgroup") == 0) preempt_mode = PREEMPT_CGROUP;
+            else usage(argv[0]);
+            break;
+        default: usage(argv[0]);
+        }
     }
+    if (swf_tick <= 0) usage(argv[0]);
+    if (convert) {
+        if (argc - optind != 2) usage(argv[0]);
+        convert_trace(argv[optind], argv[optind + 1]);
+        return 0;
+    }
+    if (optind >= argc && !online_spec) usage(argv[0]);
+    if (quantum_us <= 0 || time_scale <= 0 || ncpus < 1) usage(argv[0]);
+
+    /* Before load_jobs: a zygote must fork from a small address space */
+    ready_pipe_init();
+    spawn_init();
+    pool_init();
 
-    load_jobs(argv[1]);
-    print_job_table();
+    if (optind < argc) load_jobs(argv[optind]);
+    if (!quiet) print_job_table();
 
-    /* Count jobs and store info for statistics */
+    /* Store job info for statistics */
     int job_count = 0;
-    job_t *p = input_head;
-    while (p) { job_count++; p = p->next; }
-    
-    int *completion = calloc(job_count, sizeof(int));
-    int *arrivals = calloc(job_count, sizeof(int));
-    int *bursts = calloc(job_count, sizeof(int));
-    
-    p = input_head;
-    int idx = 0;
-    while (p) {
-        arrivals[idx] = p->arrival;
-        bursts[idx] = p->total_cpu;
-        idx++;
-        p = p->next;
-    }
+    job_stat_t *stats = stats_collect(NULL, &job_count);
 
-    for (int i = 0; i < MAX_TIME; i++) gantt[i] = -1;
+    /* Baseline for the context-switch report; the input list is consumed
+       by the run, so count it now (an online run has no whole trace) */
+    long baseline_preemptions = -1;
+    if ((policy != &rr_policy || *policy_opts) && ncpus == 1 && !online_spec)
+        baseline_preemptions = rr_q1_preemptions();
 
     int t = 0;
-    job_t *current = NULL;
+
+    cpus_init();
+    tick_engine_init();
+    event_loop_init();
+    cgroup_init();
+    if (online_spec) online_start(online_spec);
 
   
-    /* Main dispatcher loop - Following Stallings exactly */
-    while (any_jobs_left() || current != NULL) {
+    /* Main dispatcher loop - Following Stallings exactly, once per core */
+    while (any_jobs_left() || any_cpu_busy()) {
+
+        online_lookahead(t);
+        stats = stats_collect(stats, &job_count);
 
         /* Step 4.i: Unload pending processes from input queue */
         move_arrivals_to_rr(t);
 
+        /* Jobs whose process died on its own leave the system now */
+        for (int i = 0; i < crashed_count; i++) {
+            job_t *j = crashed[i];
+            cpu_t *c = &cpus[j->cpu];
+            TRACE("[t=%d] ✖ CRASH Job %d (process exited unexpectedly)\n", t, j->id);
+            stats[j->idx].completion = t;
+            stats[j->idx].crashed = 1;
+            policy_forget(c, j, t);
+            stats[j->idx].policy_stat = j->stat;
+            if (j == c->current) c->current = NULL;
+        }
+        crashed_count = 0;
+
         /* Step 4.ii: If a process is currently running */
-        if (current) {
+        for (int i = 0; i < ncpus; i++) {
+            cpu_t *c = &cpus[i];
+            job_t *current = c->current;
+            if (!current) continue;
+
             /* Step 4.ii.a: Decrement remaining CPU time */
             current->remaining--;
-            printf("[t=%d] ⚙ RAN Job %d (remaining: %d → %d)\n", 
-                   t, current->id, current->remaining + 1, current->remaining);
+            TRACE("[t=%d] ⚙ RAN Job %d (remaining: %d → %d)%s\n", 
+                   t, current->id, current->remaining + 1, current->remaining, cpu_tag(i));
+            int yield = policy->on_tick(c->rq, current, 1, t);
 
             /* Step 4.ii.b: If time's up */
             if (current->remaining <= 0) {
-                /* Terminate */
-                kill(current->pid, SIGINT);
-                waitpid(current->pid, NULL, 0);
-                printf("[t=%d] ✔ FINISH Job %d\n", t, current->id);
-                
                 // Completion time is the current time tick
-                completion[current->id - 1] = t; 
+                stats[current->idx].completion = t; 
                 
-                free(current);
-                current = NULL;
+                /* Terminate (reaped asynchronously by the event loop) */
+                policy_forget(c, current, t);
+                stats[current->idx].policy_stat = current->stat;
+                job_terminate(current, t);
+                c->current = NULL;
             }
-            /* Step 4.ii.c: else if other processes waiting */
-            else if (rr_head != NULL) {
+            /* Step 4.ii.c: else if other processes waiting and the policy
+             * wants the CPU back (RR: always) */
+            else if (yield && c->rq_len > 0) {
                 /* Suspend */
-                kill(current->pid, SIGTSTP);
-                current->state = SUSPENDED;
-                printf("[t=%d] ⏸ PREEMPT Job %d\n", t, current->id);
+                job_suspend(current, t);
+                preemptions++;
                 /* Enqueue back */
-                enqueue_rr(current);
-                current = NULL;
+                c->current = NULL;
+                enqueue_again(c, current, t);
             }
         }
 
-        /* Step 4.iii: If no process currently running && RR queue is not empty */
-        if (!current && rr_head != NULL) {
-            job_t *job = dequeue_rr();
+        /* Step 4.iii: If no process currently running && RR queue is not
+         * empty. A core with nothing of its own steals first. */
+        for (int i = 0; i < ncpus; i++) {
+            cpu_t *c = &cpus[i];
+            if (!c->current && c->rq_len == 0 && ncpus > 1) steal_work(c, t);
+            if (c->current || c->rq_len == 0) continue;
 
-            if (job->state == NOT_STARTED) {
-                pid_t pid = fork();
-                if (pid == 0) {
-                    char arg[20];
-                    sprintf(arg, "%d", job->total_cpu);
-                    execl("./jobprog", "./jobprog", arg, NULL);
-                    perror("execl");
-                    exit(1);
-                }
-                job->pid = pid;
-                job->state = RUNNING;
-                printf("[t=%d] ▶ START Job %d (pid=%d)\n", t, job->id, pid);
-                usleep(100000); 
-            } else if (job->state == SUSPENDED) {
-                kill(job->pid, SIGCONT);
-                job->state = RUNNING;
-                printf("[t=%d] ▶ RESUME Job %d (pid=%d)\n", t, job->id, job->pid);
-                usleep(50000);
-            }
+            job_t *job = dequeue_next(c, t);
+            if (!job) continue;
+            job->cpu = i;
 
-            current = job;
+            if (job->state == NOT_STARTED) job_start(job, t);
+            else if (job->state == SUSPENDED) job_resume(job, t);
+
+            c->current = job;
+            c->dispatches++;
         }
 
         /* * --- THE PERFECT FIX ---
@@ -277,26 +2734,96 @@ int main(int argc, char **argv) {
          * If the queues are empty AND no process is running,
          * we must break *before* recording an idle Gantt tick and sleeping.
          */
-        if (!any_jobs_left() && current == NULL) {
+        if (!any_jobs_left() && !any_cpu_busy()) {
             break;
         }
 
         /* Record Gantt chart entry for this time quantum */
-        gantt[gantt_index++] = current ? current->id : -1;
+        for (int i = 0; i < ncpus; i++) {
+            cpu_t *c = &cpus[i];
+            gantt_record(c, c->current ? c->current->id : -1, 1);
+            if (c->current) c->busy_ticks++;
+            if (c->current && users_live > 1) stats[c->current->idx].contended++;
+        }
 
-        /* Step 4.iv-v: Sleep and increment timer */
-        sleep(1);
-        t++;
+        /* * Event jump: while every running job has its core to itself and
+         * no queue holds anything, nothing can happen before the first
+         * completion or the next arrival (the head of the input queue,
+         * which is our event queue). Those ticks are charged in one step
+         * instead of one loop iteration each. With every core idle this
+         * is a tickless jump to the next arrival.
+         */
+        int next = t + 1;
+        if (queued_jobs == 0) {
+            int horizon = input_head ? input_head->arrival : INT_MAX;
+            for (int i = 0; i < ncpus; i++)
+                if (cpus[i].current && t + cpus[i].current->remaining < horizon)
+                    horizon = t + cpus[i].current->remaining;
+            if (horizon == INT_MAX && online_live) horizon = t + ONLINE_IDLE_TICKS;
+            if (horizon > next && horizon != INT_MAX) next = horizon;
+        }
+
+        /* Step 4.iv-v: Sleep and increment timer. A crash may end the wait
+         * early; only the ticks actually waited are charged. */
+        int reached = wait_until_tick(next);
+        int skip = reached - (t + 1);
+        if (skip > 0 && !any_cpu_busy())
+            TRACE("[t=%d..%d] · IDLE until next arrival\n", t, reached - 1);
+        for (int i = 0; i < ncpus && skip > 0; i++) {
+            cpu_t *c = &cpus[i];
+            job_t *current = c->current;
+            if (!current) {
+                gantt_record(c, -1, skip);
+                continue;
+            }
+            current->remaining -= skip;
+            policy->on_tick(c->rq, current, skip, t + 1);
+            if (skip == 1)
+                TRACE("[t=%d] ⚙ RAN Job %d (remaining: %d → %d)%s\n",
+                      t + 1, current->id, current->remaining + 1, current->remaining, cpu_tag(i));
+            else
+                TRACE("[t=%d..%d] ⚙ RAN Job %d (remaining: %d → %d)%s\n",
+                      t + 1, reached - 1, current->id,
+                      current->remaining + skip, current->remaining, cpu_tag(i));
+            gantt_record(c, current->id, skip);
+            c->busy_ticks += skip;
+            if (users_live > 1) stats[current->idx].contended += skip;
+        }
+        t = reached;
     }
     
+    event_drain();
+
     // The rest of the code is unchanged and correct.
     printf("\n✅ Dispatcher done (all jobs completed)\n");
+    if (!simulate)
+        printf("Wall time: %.3f ms for %d ticks (tick = %.1f µs)\n",
+               (now_ns() - ts_to_ns(&tick_origin)) / 1e6, t, tick_ns / 1e3);
     print_gantt_chart();
-    print_statistics(completion, arrivals, bursts, job_count);
+    print_statistics(stats, job_count);
+    if (baseline_preemptions >= 0) print_context_switches(baseline_preemptions);
+    if (ncpus > 1) print_cpu_utilization(t);
+    if (!simulate) {
+        print_dispatch_overhead();
+        print_preemption_latency();
+    }
 
-    free(completion);
-    free(arrivals);
-    free(bursts);
+    free(stats);
+    free(crashed);
+    free(pidless);
+    free(user_tab);
+    free_jobs();
+    policies_fini();
+    for (int i = 0; i < ncpus; i++) free(cpus[i].gantt.spans);
+    free(cpus);
+    if (tick_fd >= 0) close(tick_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+    if (sigchld_fd >= 0) close(sigchld_fd);
+    pool_shutdown();
+    cgroup_shutdown();
+    zygote_stop();
+    if (jobprog_fd >= 0) close(jobprog_fd);
+    free(spawn_stack);
 
     return 0;
-}
\ No newline at end of file
+}
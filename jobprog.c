@@ -7,12 +7,19 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
+#include <string.h>
+#include "jobproto.h"
 
 /* * We use a global flag to know when to terminate.
  * 'volatile sig_atomic_t' ensures it's safe to change in a signal handler.
  */
 volatile sig_atomic_t keep_running = 1;
 
+/* * Write end of the dispatcher's readiness pipe (argv[2]), or -1 when
+ * started by hand without one.
+ */
+static int ready_fd = -1;
+
 /* * This is our custom signal handler for SIGINT.
  * When the dispatcher sends SIGINT, this function runs.
  */
@@ -21,23 +28,73 @@ void sigint_handler(int signo) {
     keep_running = 0;
 }
 
+/* * Tell the dispatcher we are (again) running. write() is async-signal-safe,
+ * so this is also called from the SIGCONT handler.
+ */
+void notify(int kind) {
+    if (ready_fd < 0) return;
+    struct job_msg m = { getpid(), kind };
+    ssize_t r = write(ready_fd, &m, sizeof(m));
+    (void)r;
+}
+
+/* * SIGCONT still resumes us by default; the handler only runs once we are
+ * scheduled again, which is exactly the moment the dispatcher waits for.
+ */
+void sigcont_handler(int signo) {
+    notify(JOB_RESUMED);
+}
+
+/* * Pool mode: park on the command pipe and stand in for one job after
+ * another. SIGTSTP/SIGCONT act on a worker exactly as on a one-shot job;
+ * a stopped worker simply resumes its blocked read().
+ */
+int worker_loop(int cmd_fd) {
+    pid_t pid = getpid();
+    struct job_cmd cmd;
+
+    while (read(cmd_fd, &cmd, sizeof(cmd)) == sizeof(cmd)) {
+        if (cmd.kind == JOB_CMD_RUN) {
+            printf("[job pid=%d] started, service_time=%d\n", pid, cmd.burst);
+            fflush(stdout);
+            notify(JOB_READY);
+        } else if (cmd.kind == JOB_CMD_END) {
+            printf("[job pid=%d] job done, back to pool\n", pid);
+            fflush(stdout);
+            notify(JOB_IDLE);
+        }
+    }
+    /* EOF: the dispatcher closed the pool */
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     
+    if (argc > 3 && strcmp(argv[1], "--worker") == 0) {
+        ready_fd = atoi(argv[3]);
+        signal(SIGINT, sigint_handler);
+        signal(SIGCONT, sigcont_handler);
+        return worker_loop(atoi(argv[2]));
+    }
+
     int service_time = (argc > 1) ? atoi(argv[1]) : 0;
     pid_t pid = getpid();
+    if (argc > 2) ready_fd = atoi(argv[2]);
     
     /* * Set up our custom signal handler to catch SIGINT.
      * Now, SIGINT won't kill the process by default; it will just call our function.
      */
     signal(SIGINT, sigint_handler);
     
-    /* * We do NOT need to handle SIGTSTP (stop) or SIGCONT (continue).
-     * The default OS behavior for these signals is exactly what we want
-     * (pause the process and resume the process).
+    /* * We do NOT need to handle SIGTSTP (stop); the default OS behavior
+     * pauses the process. SIGCONT keeps its default (resume) and we only
+     * hook it to report the resume.
      */
+    signal(SIGCONT, sigcont_handler);
     
     printf("[job pid=%d] started, service_time=%d\n", pid, service_time);
     fflush(stdout); // Flush output buffer so parent sees it
+    notify(JOB_READY);
     
     /* * This is the main "work" loop.
      * It runs forever (as long as keep_running is 1).
@@ -56,4 +113,4 @@ int main(int argc, char *argv[]) {
     fflush(stdout);
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,34 @@
+/* jobproto.h
+   Wire format shared by dispatcher.c and jobprog.c.
+   A job reports over an inherited pipe (fd passed as argv[2]) that it has
+   started or has been resumed, so the dispatcher never has to guess with a
+   fixed sleep. Each message is smaller than PIPE_BUF, so writes from many
+   children never interleave.
+
+   In pool mode (`jobprog --worker CMDFD READYFD`) a parked worker reads
+   job_cmd records from its own command pipe: JOB_CMD_RUN makes it stand in
+   for a job, JOB_CMD_END returns it to the pool (acknowledged with
+   JOB_IDLE), and EOF on the pipe tells it to exit.
+*/
+
+#ifndef JOBPROTO_H
+#define JOBPROTO_H
+
+#define JOB_READY    1   /* first message after exec */
+#define JOB_RESUMED  2   /* sent from the SIGCONT handler */
+#define JOB_IDLE     3   /* pool worker finished its job and is parked */
+
+#define JOB_CMD_RUN  1
+#define JOB_CMD_END  2
+
+struct job_msg {
+    int pid;
+    int kind;
+};
+
+struct job_cmd {
+    int kind;
+    int burst;
+};
+
+#endif
@@ -0,0 +1,69 @@
+/* policies/fcfs.c
+   Example --policy module: first-come first-served. Jobs run to completion
+   in arrival order; nothing is ever preempted or stolen.
+
+   gcc -shared -fPIC -I. -o fcfs.so policies/fcfs.c
+   ./dispatcher --policy ./fcfs.so jobs.csv
+*/
+
+#include <stdlib.h>
+#include "policy.h"
+
+typedef struct {
+    job_t *head, *tail;
+} fcfs_t;
+
+static void *fcfs_init(int cpu, int ncpus, const char *opts) {
+    (void)cpu; (void)ncpus; (void)opts;
+    return calloc(1, sizeof(fcfs_t));
+}
+
+static void fcfs_fini(void *self) {
+    free(self);
+}
+
+static void fcfs_push(void *self, job_t *j, int t) {
+    fcfs_t *q = self;
+    (void)t;
+    j->next = NULL;
+    j->prev = q->tail;
+    if (q->tail) q->tail->next = j;
+    else q->head = j;
+    q->tail = j;
+}
+
+static job_t *fcfs_pick_next(void *self, int t) {
+    fcfs_t *q = self;
+    job_t *j = q->head;
+    (void)t;
+    if (!j) return NULL;
+    q->head = j->next;
+    if (q->head) q->head->prev = NULL;
+    else q->tail = NULL;
+    j->next = j->prev = NULL;
+    return j;
+}
+
+static int fcfs_on_tick(void *self, job_t *cur, int ticks, int t) {
+    (void)self; (void)cur; (void)ticks; (void)t;
+    return 0;
+}
+
+static void fcfs_on_finish(void *self, job_t *j, int queued, int t) {
+    fcfs_t *q = self;
+    (void)t;
+    if (!queued) return;
+    if (j->prev) j->prev->next = j->next;
+    else q->head = j->next;
+    if (j->next) j->next->prev = j->prev;
+    else q->tail = j->prev;
+    j->next = j->prev = NULL;
+}
+
+const sched_policy_t sched_policy = {
+    SCHED_POLICY_API, "fcfs",
+    fcfs_init, fcfs_fini,
+    fcfs_push, fcfs_pick_next, fcfs_on_tick, fcfs_push, fcfs_on_finish,
+    NULL,
+    NULL, NULL,
+};
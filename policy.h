@@ -0,0 +1,118 @@
+/* policy.h
+   Scheduling-policy interface shared by dispatcher.c, the built-in
+   policies (policy_*.c) and policy modules loaded with --policy=path.so.
+
+   The dispatcher owns processes, the clock, the Gantt chart and the
+   statistics. A policy owns the runnable jobs of one core: it is told when
+   jobs arrive, ran, were preempted or left, and answers which job runs
+   next and whether the running one should give up the CPU. One instance
+   is created per core (see --cpus).
+
+   A module exports its vtable under the symbol name "sched_policy":
+       const sched_policy_t sched_policy = { SCHED_POLICY_API, "name", ... };
+   and is built with: gcc -shared -fPIC -o name.so name.c
+*/
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#define SCHED_POLICY_API 8
+
+typedef enum { NOT_STARTED, RUNNING, SUSPENDED, TERMINATED, CRASHED } state_t;
+
+typedef struct job {
+    int id;
+    int idx;            /* load order, indexes the statistics arrays */
+    int arrival;
+    int total_cpu;
+    int remaining;
+    int priority;       /* CSV column 2; 0 = most urgent, 0 if absent */
+    int deadline;       /* CSV column 9: tick to finish by, -1 = none */
+    int quantum;        /* CSV column 10: ticks per turn, 0 = policy's choice */
+    int job_class;      /* CSV column 11: repeat job type, 0 if absent */
+    int user;           /* CSV column 12: submitting user, 0 if absent */
+    int group;          /* CSV column 13: the user's group, 0 if absent */
+    int memory;         /* CSV column 4 or SWF requested memory, 0 if absent */
+    int procs;          /* SWF requested processors, 1 otherwise */
+    pid_t pid;
+    int pidfd;          /* -1 when the kernel gave us none */
+    int worker;         /* pool slot standing in for this job, or -1 */
+    int cg_fd;          /* cgroup v2 leaf directory, -1 = signal preemption */
+    int cg_events_fd;   /* that leaf's cgroup.events */
+    int cpu;            /* core whose run queue / slot holds the job */
+    int pinned_cpu;     /* core the process is pinned to, -1 = none */
+    state_t state;
+    struct job *next, *prev;    /* free for the policy while it holds the job */
+    void *policy_data;          /* private to the policy, NULL on arrival */
+    double stat;                /* set by on_finish for the stat_name column */
+} job_t;
+
+typedef struct sched_policy {
+    int api;            /* SCHED_POLICY_API the module was built against */
+    const char *name;
+
+    /* Create the state for core `cpu` of `ncpus`. `opts` is the
+       --policy-opt string (never NULL). Return NULL to refuse. */
+    void *(*init)(int cpu, int ncpus, const char *opts);
+    void (*fini)(void *self);
+
+    /* A new job becomes runnable on this core */
+    void (*on_arrival)(void *self, job_t *j, int t);
+
+    /* Remove and return the job to run next, or NULL to leave the core idle */
+    job_t *(*pick_next)(void *self, int t);
+
+    /* The running job `cur` was charged `ticks` more ticks (its remaining
+       may now be 0; on_finish follows). Return nonzero to preempt it. The
+       dispatcher only preempts when this core has other runnable jobs;
+       during a multi-tick jump (nothing else runnable) the answer is
+       ignored. */
+    int (*on_tick)(void *self, job_t *cur, int ticks, int t);
+
+    /* A job already seen by some core re-enters this core's queue: after
+       being preempted here, or when stolen from another core */
+    void (*on_preempt)(void *self, job_t *j, int t);
+
+    /* The job leaves the system (finished or crashed). `queued` says it is
+       still in this core's queue and must be unlinked. */
+    void (*on_finish)(void *self, job_t *j, int queued, int t);
+
+    /* Optional (may be NULL): give up one queued job to an idle core */
+    job_t *(*steal)(void *self);
+
+    /* Optional: header of an extra per-job column in the statistics
+       table, filled from job_t.stat */
+    const char *stat_name;
+
+    /* Optional: print a policy summary after the statistics, given the
+       instances of all `n` cores */
+    void (*report)(void **selves, int n);
+} sched_policy_t;
+
+/* Integer `key` from a --policy-opt string such as "levels=4,boost=50",
+   or `def` when the key is absent */
+static inline int policy_opt_int(const char *opts, const char *key, int def) {
+    size_t n = strlen(key);
+    for (const char *p = opts; p && *p; p = strchr(p, ',') ? strchr(p, ',') + 1 : NULL) {
+        if (strncmp(p, key, n) == 0 && p[n] == '=') return atoi(p + n + 1);
+    }
+    return def;
+}
+
+/* Built-in policies */
+extern const sched_policy_t rr_policy;
+extern const sched_policy_t mlfq_policy;
+extern const sched_policy_t cfs_policy;
+extern const sched_policy_t edf_policy;
+extern const sched_policy_t lottery_policy;
+extern const sched_policy_t stride_policy;
+extern const sched_policy_t drr_policy;
+extern const sched_policy_t sjf_policy;
+extern const sched_policy_t srtf_policy;
+extern const sched_policy_t fair_policy;
+
+#endif
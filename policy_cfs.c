@@ -0,0 +1,424 @@
+/* policy_cfs.c
+   Built-in completely-fair scheduler (--policy cfs), after Linux CFS.
+
+   Runnable jobs sit in a red-black tree ordered by virtual runtime; the
+   leftmost node is cached, so picking is O(1) and every insert or erase
+   is O(log n). A job's weight comes from its CSV priority, read as a nice
+   value (nice = priority * step) through the kernel's nice-to-weight
+   table. A tick of CPU advances vruntime by NICE_0_WEIGHT / weight, so
+   heavier jobs age slower and get proportionally more CPU.
+
+   The running job's slice is its weighted part of the scheduling period:
+   period = max(latency, nr_runnable * min_gran), and
+   slice = max(min_gran, period * weight / total_weight).
+   New jobs start at the core's min_vruntime. A stolen job carries its
+   vruntime relative to the victim core's min_vruntime.
+
+   To compare what a job got with what it was owed, each core integrates
+   1 / total_weight over time. A job's entitlement is its weight times the
+   growth of that integral while it was runnable on the core. It lands in
+   the Entitled statistics column, next to the burst it actually received.
+
+   --policy-opt keys: latency=N (default 6 ticks), min_gran=N (default 1),
+   step=N (default 1).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+#define NICE_0_WEIGHT   1024
+#define VRUNTIME_SHIFT  20      /* vruntime units per tick at NICE_0_WEIGHT */
+
+/* Linux sched_prio_to_weight[]: nice -20 .. 19, ~1.25x per step */
+static const int nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+
+typedef struct cfs_node {
+    struct cfs_node *parent, *left, *right;
+    int red;
+    job_t *job;
+    unsigned long long vruntime;
+    unsigned long long seq;     /* tie-break: earlier enqueue first */
+    int weight;
+    int used, slice;            /* ticks of the current slice */
+    int migrating;              /* vruntime is relative (stolen) */
+    double ent_base;            /* core's integral when it became runnable here */
+    double entitled;            /* CPU ticks owed on cores it already left */
+} cfs_node_t;
+
+typedef struct {
+    cfs_node_t *root, *leftmost;
+    cfs_node_t *curr;
+    unsigned long long min_vruntime, seq;
+    long long load;             /* total weight of queued + running */
+    int nr;                     /* queued + running */
+    double ent;                 /* integral of 1 / load over time */
+    int ent_time, now;
+    int latency, min_gran, step;
+    /* share vs entitlement over finished jobs */
+    int finished;
+    double err_sum, err_max;
+    int err_max_id;
+} cfs_t;
+
+static void *cfs_init(int cpu, int ncpus, const char *opts) {
+    cfs_t *q = calloc(1, sizeof(cfs_t));
+    if (!q) return NULL;
+    q->latency = policy_opt_int(opts, "latency", 6);
+    q->min_gran = policy_opt_int(opts, "min_gran", 1);
+    q->step = policy_opt_int(opts, "step", 1);
+    if (q->latency < 1 || q->min_gran < 1 || q->step < 0) {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+
+static void cfs_fini(void *self) {
+    free(self);
+}
+
+/* ---------------- RED-BLACK TREE ---------------- */
+
+static int node_less(const cfs_node_t *a, const cfs_node_t *b) {
+    if (a->vruntime != b->vruntime) return a->vruntime < b->vruntime;
+    return a->seq < b->seq;
+}
+
+static void rotate_left(cfs_t *q, cfs_node_t *x) {
+    cfs_node_t *y = x->right;
+    x->right = y->left;
+    if (y->left) y->left->parent = x;
+    y->parent = x->parent;
+    if (!x->parent) q->root = y;
+    else if (x == x->parent->left) x->parent->left = y;
+    else x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+}
+
+static void rotate_right(cfs_t *q, cfs_node_t *x) {
+    cfs_node_t *y = x->left;
+    x->left = y->right;
+    if (y->right) y->right->parent = x;
+    y->parent = x->parent;
+    if (!x->parent) q->root = y;
+    else if (x == x->parent->right) x->parent->right = y;
+    else x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+}
+
+static void rb_insert(cfs_t *q, cfs_node_t *z) {
+    cfs_node_t *p = NULL, **link = &q->root;
+    int leftmost = 1;
+    while (*link) {
+        p = *link;
+        if (node_less(z, p)) link = &p->left;
+        else { link = &p->right; leftmost = 0; }
+    }
+    z->parent = p;
+    z->left = z->right = NULL;
+    z->red = 1;
+    *link = z;
+    if (leftmost) q->leftmost = z;
+
+    while (z->parent && z->parent->red) {
+        cfs_node_t *g = z->parent->parent;
+        if (z->parent == g->left) {
+            cfs_node_t *u = g->right;
+            if (u && u->red) {
+                z->parent->red = u->red = 0;
+                g->red = 1;
+                z = g;
+            } else {
+                if (z == z->parent->right) { z = z->parent; rotate_left(q, z); }
+                z->parent->red = 0;
+                g->red = 1;
+                rotate_right(q, g);
+            }
+        } else {
+            cfs_node_t *u = g->left;
+            if (u && u->red) {
+                z->parent->red = u->red = 0;
+                g->red = 1;
+                z = g;
+            } else {
+                if (z == z->parent->left) { z = z->parent; rotate_right(q, z); }
+                z->parent->red = 0;
+                g->red = 1;
+                rotate_left(q, g);
+            }
+        }
+    }
+    q->root->red = 0;
+}
+
+static cfs_node_t *rb_next(cfs_node_t *n) {
+    if (n->right) {
+        n = n->right;
+        while (n->left) n = n->left;
+        return n;
+    }
+    while (n->parent && n == n->parent->right) n = n->parent;
+    return n->parent;
+}
+
+/* Put `v` where `u` was */
+static void rb_transplant(cfs_t *q, cfs_node_t *u, cfs_node_t *v) {
+    if (!u->parent) q->root = v;
+    else if (u == u->parent->left) u->parent->left = v;
+    else u->parent->right = v;
+    if (v) v->parent = u->parent;
+}
+
+static void rb_erase(cfs_t *q, cfs_node_t *z) {
+    if (q->leftmost == z) q->leftmost = rb_next(z);
+
+    cfs_node_t *x, *xp;         /* x may be NULL, so track its parent */
+    int removed_red = z->red;
+    if (!z->left) {
+        x = z->right;
+        xp = z->parent;
+        rb_transplant(q, z, z->right);
+    } else if (!z->right) {
+        x = z->left;
+        xp = z->parent;
+        rb_transplant(q, z, z->left);
+    } else {
+        cfs_node_t *y = z->right;
+        while (y->left) y = y->left;
+        removed_red = y->red;
+        x = y->right;
+        if (y->parent == z) {
+            xp = y;
+        } else {
+            xp = y->parent;
+            rb_transplant(q, y, y->right);
+            y->right = z->right;
+            y->right->parent = y;
+        }
+        rb_transplant(q, z, y);
+        y->left = z->left;
+        y->left->parent = y;
+        y->red = z->red;
+    }
+    if (removed_red) return;
+
+    while (x != q->root && (!x || !x->red)) {
+        if (x == xp->left) {
+            cfs_node_t *w = xp->right;
+            if (w->red) {
+                w->red = 0; xp->red = 1;
+                rotate_left(q, xp);
+                w = xp->right;
+            }
+            if ((!w->left || !w->left->red) && (!w->right || !w->right->red)) {
+                w->red = 1;
+                x = xp;
+                xp = x->parent;
+            } else {
+                if (!w->right || !w->right->red) {
+                    w->left->red = 0; w->red = 1;
+                    rotate_right(q, w);
+                    w = xp->right;
+                }
+                w->red = xp->red;
+                xp->red = 0;
+                if (w->right) w->right->red = 0;
+                rotate_left(q, xp);
+                x = q->root;
+            }
+        } else {
+            cfs_node_t *w = xp->left;
+            if (w->red) {
+                w->red = 0; xp->red = 1;
+                rotate_right(q, xp);
+                w = xp->left;
+            }
+            if ((!w->left || !w->left->red) && (!w->right || !w->right->red)) {
+                w->red = 1;
+                x = xp;
+                xp = x->parent;
+            } else {
+                if (!w->left || !w->left->red) {
+                    w->right->red = 0; w->red = 1;
+                    rotate_left(q, w);
+                    w = xp->left;
+                }
+                w->red = xp->red;
+                xp->red = 0;
+                if (w->left) w->left->red = 0;
+                rotate_right(q, xp);
+                x = q->root;
+            }
+        }
+    }
+    if (x) x->red = 0;
+}
+
+/* ---------------- ACCOUNTING ---------------- */
+
+/* Bring the entitlement integral up to time t at the current load. Must
+   run before anything changes the runnable set. */
+static void ent_advance(cfs_t *q, int t) {
+    if (t > q->now) q->now = t;
+    if (q->load > 0 && t > q->ent_time)
+        q->ent += (double)(t - q->ent_time) / q->load;
+    if (t > q->ent_time) q->ent_time = t;
+}
+
+static void update_min_vruntime(cfs_t *q) {
+    unsigned long long v = q->min_vruntime;
+    if (q->curr) v = q->curr->vruntime;
+    if (q->leftmost && (!q->curr || q->leftmost->vruntime < v)) v = q->leftmost->vruntime;
+    if (v > q->min_vruntime) q->min_vruntime = v;
+}
+
+/* The job joins this core's runnable set */
+static void join(cfs_t *q, cfs_node_t *n, int t) {
+    ent_advance(q, t);
+    n->ent_base = q->ent;
+    q->load += n->weight;
+    q->nr++;
+}
+
+/* The job leaves this core's runnable set; settle what it was owed here */
+static void leave(cfs_t *q, cfs_node_t *n, int t) {
+    ent_advance(q, t);
+    n->entitled += n->weight * (q->ent - n->ent_base);
+    q->load -= n->weight;
+    q->nr--;
+}
+
+static void enqueue(cfs_t *q, cfs_node_t *n) {
+    n->seq = q->seq++;
+    rb_insert(q, n);
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void cfs_on_arrival(void *self, job_t *j, int t) {
+    cfs_t *q = self;
+    cfs_node_t *n = calloc(1, sizeof(cfs_node_t));
+    if (!n) { perror("calloc"); exit(1); }
+    int nice = j->priority * q->step;
+    if (nice < -20) nice = -20;
+    if (nice > 19) nice = 19;
+    n->job = j;
+    n->weight = nice_to_weight[nice + 20];
+    n->vruntime = q->min_vruntime;
+    j->policy_data = n;
+    join(q, n, t);
+    enqueue(q, n);
+}
+
+static job_t *cfs_pick_next(void *self, int t) {
+    cfs_t *q = self;
+    cfs_node_t *n = q->leftmost;
+    ent_advance(q, t);
+    if (!n) return NULL;
+    rb_erase(q, n);
+    q->curr = n;
+
+    long long period = q->latency;
+    if ((long long)q->nr * q->min_gran > period) period = (long long)q->nr * q->min_gran;
+    n->slice = (int)(period * n->weight / q->load);
+    if (n->slice < q->min_gran) n->slice = q->min_gran;
+    n->used = 0;
+    return n->job;
+}
+
+static int cfs_on_tick(void *self, job_t *cur, int ticks, int t) {
+    cfs_t *q = self;
+    cfs_node_t *n = cur->policy_data;
+    ent_advance(q, t);
+    n->vruntime += ((unsigned long long)ticks << VRUNTIME_SHIFT) * NICE_0_WEIGHT / n->weight;
+    n->used += ticks;
+    update_min_vruntime(q);
+    return n->used >= n->slice;
+}
+
+static void cfs_on_preempt(void *self, job_t *j, int t) {
+    cfs_t *q = self;
+    cfs_node_t *n = j->policy_data;
+    if (n->migrating) {
+        n->migrating = 0;
+        n->vruntime += q->min_vruntime;
+        join(q, n, t);
+    } else {
+        ent_advance(q, t);
+    }
+    if (q->curr == n) q->curr = NULL;
+    enqueue(q, n);
+    update_min_vruntime(q);
+}
+
+static void cfs_on_finish(void *self, job_t *j, int queued, int t) {
+    cfs_t *q = self;
+    cfs_node_t *n = j->policy_data;
+    if (queued) rb_erase(q, n);
+    if (q->curr == n) q->curr = NULL;
+    leave(q, n, t);
+    update_min_vruntime(q);
+
+    int got = j->total_cpu - j->remaining;
+    double err = got > n->entitled ? got - n->entitled : n->entitled - got;
+    q->finished++;
+    q->err_sum += err;
+    if (err > q->err_max || q->finished == 1) {
+        q->err_max = err;
+        q->err_max_id = j->id;
+    }
+    j->stat = n->entitled;
+    free(n);
+    j->policy_data = NULL;
+}
+
+/* Give away the queued job with the largest vruntime: it would wait
+   longest here */
+static job_t *cfs_steal(void *self) {
+    cfs_t *q = self;
+    cfs_node_t *n = q->root;
+    if (!n) return NULL;
+    while (n->right) n = n->right;
+    rb_erase(q, n);
+    leave(q, n, q->now);
+    n->vruntime = n->vruntime > q->min_vruntime ? n->vruntime - q->min_vruntime : 0;
+    n->migrating = 1;
+    return n->job;
+}
+
+static void cfs_report(void **selves, int n) {
+    int finished = 0, max_id = -1;
+    double sum = 0, max = 0;
+    for (int i = 0; i < n; i++) {
+        cfs_t *q = selves[i];
+        finished += q->finished;
+        sum += q->err_sum;
+        if (q->finished && (max_id < 0 || q->err_max > max)) {
+            max = q->err_max;
+            max_id = q->err_max_id;
+        }
+    }
+    if (!finished) return;
+    printf("CFS share vs entitlement: mean |got - entitled| = %.2f ticks, "
+           "max = %.2f (Job %d)\n", sum / finished, max, max_id);
+}
+
+const sched_policy_t cfs_policy = {
+    SCHED_POLICY_API, "cfs",
+    cfs_init, cfs_fini,
+    cfs_on_arrival, cfs_pick_next, cfs_on_tick, cfs_on_preempt, cfs_on_finish,
+    cfs_steal,
+    "Entitled", cfs_report,
+};
@@ -0,0 +1,146 @@
+/* policy_edf.c
+   Built-in earliest-deadline-first (--policy edf).
+
+   Runnable jobs sit in a d-ary min-heap keyed on (deadline, load order).
+   Jobs with no deadline (CSV column 9 absent or <= 0) sort after every job
+   that has one, first come first served. Each job's heap slot is kept in
+   its policy_data, so a queued job can be removed in O(log n) when it
+   crashes or is stolen. Scheduling is preemptive: the running job gives
+   way as soon as a queued job has an earlier deadline. An idle core
+   steals the most urgent job, since it can run it right away.
+
+   --policy-opt keys: d=N heap arity (default 4, 2..16).
+*/
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+typedef struct {
+    job_t **heap;
+    int len, cap;
+    int d;
+} edf_t;
+
+#define HEAP_POS(j)         ((int)(intptr_t)(j)->policy_data)
+#define SET_HEAP_POS(j, i)  ((j)->policy_data = (void *)(intptr_t)(i))
+
+static void *edf_init(int cpu, int ncpus, const char *opts) {
+    edf_t *q = calloc(1, sizeof(edf_t));
+    if (!q) return NULL;
+    q->d = policy_opt_int(opts, "d", 4);
+    if (q->d < 2 || q->d > 16) {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+
+static void edf_fini(void *self) {
+    edf_t *q = self;
+    free(q->heap);
+    free(q);
+}
+
+/* ---------------- INDEXED D-ARY HEAP ---------------- */
+
+static int deadline_key(const job_t *j) {
+    return j->deadline > 0 ? j->deadline : INT_MAX;
+}
+
+static int job_before(const job_t *a, const job_t *b) {
+    int ka = deadline_key(a), kb = deadline_key(b);
+    if (ka != kb) return ka < kb;
+    return a->idx < b->idx;
+}
+
+static void heap_place(edf_t *q, int i, job_t *j) {
+    q->heap[i] = j;
+    SET_HEAP_POS(j, i);
+}
+
+static void sift_up(edf_t *q, int i) {
+    job_t *j = q->heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / q->d;
+        if (!job_before(j, q->heap[parent])) break;
+        heap_place(q, i, q->heap[parent]);
+        i = parent;
+    }
+    heap_place(q, i, j);
+}
+
+static void sift_down(edf_t *q, int i) {
+    job_t *j = q->heap[i];
+    for (;;) {
+        int first = i * q->d + 1;
+        if (first >= q->len) break;
+        int last = first + q->d < q->len ? first + q->d : q->len;
+        int best = first;
+        for (int c = first + 1; c < last; c++)
+            if (job_before(q->heap[c], q->heap[best])) best = c;
+        if (!job_before(q->heap[best], j)) break;
+        heap_place(q, i, q->heap[best]);
+        i = best;
+    }
+    heap_place(q, i, j);
+}
+
+static void heap_push(edf_t *q, job_t *j) {
+    if (q->len == q->cap) {
+        q->cap = q->cap ? q->cap * 2 : 64;
+        q->heap = realloc(q->heap, q->cap * sizeof(job_t *));
+        if (!q->heap) { perror("realloc"); exit(1); }
+    }
+    heap_place(q, q->len++, j);
+    sift_up(q, q->len - 1);
+}
+
+static void heap_remove(edf_t *q, job_t *j) {
+    int i = HEAP_POS(j);
+    job_t *moved = q->heap[--q->len];
+    if (i < q->len) {
+        heap_place(q, i, moved);
+        if (i > 0 && job_before(moved, q->heap[(i - 1) / q->d])) sift_up(q, i);
+        else sift_down(q, i);
+    }
+    SET_HEAP_POS(j, -1);
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void edf_push(void *self, job_t *j, int t) {
+    heap_push(self, j);
+}
+
+static job_t *edf_pick_next(void *self, int t) {
+    edf_t *q = self;
+    if (q->len == 0) return NULL;
+    job_t *j = q->heap[0];
+    heap_remove(q, j);
+    return j;
+}
+
+static int edf_on_tick(void *self, job_t *cur, int ticks, int t) {
+    edf_t *q = self;
+    return q->len > 0 && job_before(q->heap[0], cur);
+}
+
+static void edf_on_finish(void *self, job_t *j, int queued, int t) {
+    if (queued) heap_remove(self, j);
+    j->policy_data = NULL;
+}
+
+static job_t *edf_steal(void *self) {
+    return edf_pick_next(self, 0);
+}
+
+const sched_policy_t edf_policy = {
+    SCHED_POLICY_API, "edf",
+    edf_init, edf_fini,
+    edf_push, edf_pick_next, edf_on_tick, edf_push, edf_on_finish,
+    edf_steal,
+    NULL, NULL,
+};
@@ -0,0 +1,294 @@
+/* policy_fair.c
+   Built-in hierarchical fair share (--policy fair).
+
+   Three levels: groups (CSV column 13), users within a group (column 12),
+   then Round-Robin among one user's jobs. Both columns default to 0, so a
+   trace with neither is plain RR and one with users only is two-level.
+   At each level the child with the least decayed CPU usage goes next: the
+   core's groups sit in a min-heap on usage, and each group holds its
+   users in another. A pick is two O(log n) heap lookups plus a FIFO pop.
+   A user who submits 500 jobs competes as one user, not as 500 jobs.
+
+   Usage decays with a half-life of `halflife` ticks. Rather than aging
+   every entity each tick, a charge made at time t is scaled up by
+   2^(t / halflife). Every entity is discounted by the same factor, so the
+   heaps stay in order and only the charged user and group move. When the
+   scale grows too large, all usages are divided down at once.
+
+   An entity leaves its parent's heap while it has nothing runnable,
+   including while its only job is running, and rejoins when a job is
+   queued again. Each core keeps its own groups and users.
+
+   --policy-opt keys: halflife=N ticks (default 100), quantum=N ticks
+   (default 1).
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+#define RESCALE_EXP 256         /* renormalize once the scale passes 2^256 */
+
+struct fs_entity;
+
+typedef struct {
+    struct fs_entity **a;
+    int len, cap;
+} fs_heap_t;
+
+typedef struct fs_entity {
+    long long key;              /* group, or group << 32 | user */
+    double usage;               /* scaled, see above */
+    int heap_pos;               /* in the parent's heap, -1 = not runnable */
+    struct fs_entity *group;    /* users: their group */
+    fs_heap_t users;            /* groups: their runnable users */
+    job_t *head, *tail;         /* users: runnable jobs, FIFO */
+} fs_entity_t;
+
+/* Open-addressing map key -> entity */
+typedef struct {
+    fs_entity_t **slot;
+    int cap, count;
+} fs_map_t;
+
+typedef struct {
+    fs_heap_t groups;
+    fs_map_t group_map, user_map;
+    double halflife;
+    int base_t;                 /* usages are scaled relative to this tick */
+    int quantum, ran;
+} fair_t;
+
+static void *fair_init(int cpu, int ncpus, const char *opts) {
+    fair_t *q = calloc(1, sizeof(fair_t));
+    if (!q) return NULL;
+    int halflife = policy_opt_int(opts, "halflife", 100);
+    q->quantum = policy_opt_int(opts, "quantum", 1);
+    if (halflife < 1 || q->quantum < 1) {
+        free(q);
+        return NULL;
+    }
+    q->halflife = halflife;
+    return q;
+}
+
+static void map_free(fs_map_t *m) {
+    for (int i = 0; i < m->cap; i++) {
+        if (!m->slot[i]) continue;
+        free(m->slot[i]->users.a);
+        free(m->slot[i]);
+    }
+    free(m->slot);
+}
+
+static void fair_fini(void *self) {
+    fair_t *q = self;
+    map_free(&q->group_map);
+    map_free(&q->user_map);
+    free(q->groups.a);
+    free(q);
+}
+
+/* ---------------- ENTITY MAP ---------------- */
+
+static fs_entity_t **map_find(fs_map_t *m, long long key) {
+    unsigned long long h = (unsigned long long)key * 0x9e3779b97f4a7c15ULL;
+    for (int i = (int)(h >> 32) & (m->cap - 1); ; i = (i + 1) & (m->cap - 1))
+        if (!m->slot[i] || m->slot[i]->key == key) return &m->slot[i];
+}
+
+static fs_entity_t *map_get(fs_map_t *m, long long key) {
+    if ((m->count + 1) * 2 > m->cap) {
+        fs_entity_t **old = m->slot;
+        int old_cap = m->cap;
+        m->cap = m->cap ? m->cap * 2 : 64;
+        m->slot = calloc(m->cap, sizeof(fs_entity_t *));
+        if (!m->slot) { perror("calloc"); exit(1); }
+        for (int i = 0; i < old_cap; i++)
+            if (old[i]) *map_find(m, old[i]->key) = old[i];
+        free(old);
+    }
+    fs_entity_t **s = map_find(m, key);
+    if (!*s) {
+        *s = calloc(1, sizeof(fs_entity_t));
+        if (!*s) { perror("calloc"); exit(1); }
+        (*s)->key = key;
+        (*s)->heap_pos = -1;
+        m->count++;
+    }
+    return *s;
+}
+
+/* ---------------- USAGE MIN-HEAP ---------------- */
+
+static int less_used(const fs_entity_t *a, const fs_entity_t *b) {
+    if (a->usage != b->usage) return a->usage < b->usage;
+    return a->key < b->key;
+}
+
+static void heap_place(fs_heap_t *h, int i, fs_entity_t *e) {
+    h->a[i] = e;
+    e->heap_pos = i;
+}
+
+static void sift_up(fs_heap_t *h, int i) {
+    fs_entity_t *e = h->a[i];
+    while (i > 0 && less_used(e, h->a[(i - 1) / 2])) {
+        heap_place(h, i, h->a[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    heap_place(h, i, e);
+}
+
+static void sift_down(fs_heap_t *h, int i) {
+    fs_entity_t *e = h->a[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= h->len) break;
+        if (c + 1 < h->len && less_used(h->a[c + 1], h->a[c])) c++;
+        if (!less_used(h->a[c], e)) break;
+        heap_place(h, i, h->a[c]);
+        i = c;
+    }
+    heap_place(h, i, e);
+}
+
+static void heap_push(fs_heap_t *h, fs_entity_t *e) {
+    if (h->len == h->cap) {
+        h->cap = h->cap ? h->cap * 2 : 16;
+        h->a = realloc(h->a, h->cap * sizeof(fs_entity_t *));
+        if (!h->a) { perror("realloc"); exit(1); }
+    }
+    heap_place(h, h->len++, e);
+    sift_up(h, h->len - 1);
+}
+
+static void heap_remove(fs_heap_t *h, fs_entity_t *e) {
+    int i = e->heap_pos;
+    fs_entity_t *moved = h->a[--h->len];
+    if (i < h->len) {
+        heap_place(h, i, moved);
+        if (i > 0 && less_used(moved, h->a[(i - 1) / 2])) sift_up(h, i);
+        else sift_down(h, i);
+    }
+    e->heap_pos = -1;
+}
+
+/* Re-seat an entity whose usage only grew */
+static void heap_charged(fs_heap_t *h, fs_entity_t *e) {
+    if (e->heap_pos >= 0) sift_down(h, e->heap_pos);
+}
+
+/* ---------------- DECAYED USAGE ---------------- */
+
+static void rescale_map(fs_map_t *m, double f) {
+    for (int i = 0; i < m->cap; i++)
+        if (m->slot[i]) m->slot[i]->usage *= f;
+}
+
+static void charge(fair_t *q, fs_entity_t *user, int ticks, int t) {
+    double e = (t - q->base_t) / q->halflife;
+    if (e > RESCALE_EXP) {
+        double f = exp2(-e);
+        rescale_map(&q->group_map, f);
+        rescale_map(&q->user_map, f);
+        q->base_t = t;
+        e = 0;
+    }
+    double c = ticks * exp2(e);
+    fs_entity_t *g = user->group;
+    user->usage += c;
+    g->usage += c;
+    heap_charged(&g->users, user);
+    heap_charged(&q->groups, g);
+}
+
+/* ---------------- USER QUEUES ---------------- */
+
+static void user_push(fair_t *q, fs_entity_t *u, job_t *j) {
+    j->next = NULL;
+    j->prev = u->tail;
+    if (u->tail) u->tail->next = j;
+    else u->head = j;
+    u->tail = j;
+
+    fs_entity_t *g = u->group;
+    if (u->heap_pos < 0) heap_push(&g->users, u);
+    if (g->heap_pos < 0) heap_push(&q->groups, g);
+}
+
+static void user_remove(fair_t *q, fs_entity_t *u, job_t *j) {
+    if (j->prev) j->prev->next = j->next;
+    else u->head = j->next;
+    if (j->next) j->next->prev = j->prev;
+    else u->tail = j->prev;
+    j->next = j->prev = NULL;
+
+    fs_entity_t *g = u->group;
+    if (!u->head) heap_remove(&g->users, u);
+    if (g->users.len == 0 && g->heap_pos >= 0) heap_remove(&q->groups, g);
+}
+
+static fs_entity_t *user_of(fair_t *q, job_t *j) {
+    unsigned long long ukey = (unsigned long long)(unsigned int)j->group << 32 | (unsigned int)j->user;
+    fs_entity_t *u = map_get(&q->user_map, (long long)ukey);
+    if (!u->group) u->group = map_get(&q->group_map, j->group);
+    return u;
+}
+
+/* The user owed the most CPU: least-used group, then its least-used user */
+static fs_entity_t *most_deserving(fair_t *q) {
+    if (q->groups.len == 0) return NULL;
+    return q->groups.a[0]->users.a[0];
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void fair_push(void *self, job_t *j, int t) {
+    fair_t *q = self;
+    if (!j->policy_data) j->policy_data = user_of(q, j);   /* new, or stolen */
+    user_push(q, j->policy_data, j);
+}
+
+static job_t *fair_pick_next(void *self, int t) {
+    fair_t *q = self;
+    fs_entity_t *u = most_deserving(q);
+    if (!u) return NULL;
+    job_t *j = u->head;
+    user_remove(q, u, j);
+    q->ran = 0;
+    return j;
+}
+
+static int fair_on_tick(void *self, job_t *cur, int ticks, int t) {
+    fair_t *q = self;
+    charge(q, cur->policy_data, ticks, t);
+    q->ran += ticks;
+    return q->ran >= q->quantum;
+}
+
+static void fair_on_finish(void *self, job_t *j, int queued, int t) {
+    if (queued) user_remove(self, j->policy_data, j);
+    j->policy_data = NULL;
+}
+
+/* Hand the idle core the newest job of the user owed the most; the
+   entity belongs to this core, so the thief looks the user up again */
+static job_t *fair_steal(void *self) {
+    fair_t *q = self;
+    fs_entity_t *u = most_deserving(q);
+    if (!u) return NULL;
+    job_t *j = u->tail;
+    user_remove(q, u, j);
+    j->policy_data = NULL;
+    return j;
+}
+
+const sched_policy_t fair_policy = {
+    SCHED_POLICY_API, "fair",
+    fair_init, fair_fini,
+    fair_push, fair_pick_next, fair_on_tick, fair_push, fair_on_finish,
+    fair_steal,
+    NULL, NULL,
+};
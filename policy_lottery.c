@@ -0,0 +1,210 @@
+/* policy_lottery.c
+   Built-in lottery scheduling (--policy lottery), after Waldspurger & Weihl.
+
+   Every runnable job holds tickets = base / (priority + 1), so priority 0
+   gets the most. After each quantum the core holds a lottery among its
+   runnable jobs, the running one included. If the running job wins it
+   keeps the CPU without being suspended; otherwise the winner is held for
+   the pick_next that follows the preemption. Jobs occupy slots of a Fenwick tree over ticket counts.
+   The draw descends the tree in O(log n), and a job arriving or leaving
+   is one O(log n) update. Freed slots are reused; when the tree fills up
+   it doubles and is rebuilt in O(n).
+
+   Draws come from a xorshift64* generator seeded per core from seed + cpu,
+   so the same trace, seed and --cpus reproduce the same Gantt chart.
+
+   --policy-opt keys: seed=N (default 1), base=N (default 100),
+   quantum=N ticks (default 1).
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+typedef struct {
+    long long *tree;        /* Fenwick tree, 1-based, cap entries */
+    long long *tickets;     /* per slot, 0 = free */
+    job_t **slot;
+    int *free_slots, nfree;
+    int cap, used;          /* slots [0, used) have been handed out */
+    long long total;
+    uint64_t rng;
+    int base, quantum;
+    int ran;                /* ticks the running job has had this quantum */
+    job_t *winner;          /* drawn by on_tick, out of the tree, runs next */
+} lottery_t;
+
+#define SLOT(j)         ((int)(intptr_t)(j)->policy_data)
+#define SET_SLOT(j, i)  ((j)->policy_data = (void *)(intptr_t)(i))
+
+/* splitmix64 finalizer: spreads small consecutive seeds over the state
+   space and never yields 0 for them, which xorshift could not leave */
+static uint64_t seed_mix(uint64_t z) {
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static void *lottery_init(int cpu, int ncpus, const char *opts) {
+    lottery_t *q = calloc(1, sizeof(lottery_t));
+    if (!q) return NULL;
+    q->base = policy_opt_int(opts, "base", 100);
+    q->quantum = policy_opt_int(opts, "quantum", 1);
+    q->rng = seed_mix((uint64_t)policy_opt_int(opts, "seed", 1) + cpu);
+    if (q->base < 1 || q->quantum < 1) {
+        free(q);
+        return NULL;
+    }
+    if (q->rng == 0) q->rng = 1;
+    return q;
+}
+
+static void lottery_fini(void *self) {
+    lottery_t *q = self;
+    free(q->tree);
+    free(q->tickets);
+    free(q->slot);
+    free(q->free_slots);
+    free(q);
+}
+
+static uint64_t xorshift64s(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *s = x;
+    return x * 0x2545f4914f6cdd1dULL;
+}
+
+/* ---------------- FENWICK TREE ---------------- */
+
+static void fenwick_add(lottery_t *q, int i, long long delta) {
+    for (i++; i <= q->cap; i += i & -i) q->tree[i] += delta;
+    q->total += delta;
+}
+
+/* Slot whose ticket range contains `r` (0 <= r < total): descend to the
+   largest prefix whose sum is <= r; the slot after it holds ticket r */
+static int fenwick_find(lottery_t *q, long long r) {
+    int pos = 0;
+    int step = 1;
+    while (step * 2 <= q->cap) step *= 2;
+    for (; step; step >>= 1) {
+        if (pos + step <= q->cap && q->tree[pos + step] <= r) {
+            pos += step;
+            r -= q->tree[pos];
+        }
+    }
+    return pos;     /* 1-based pos + 1 is 0-based slot pos */
+}
+
+static void grow(lottery_t *q) {
+    int cap = q->cap ? q->cap * 2 : 64;
+    q->tree = realloc(q->tree, (cap + 1) * sizeof(long long));
+    q->tickets = realloc(q->tickets, cap * sizeof(long long));
+    q->slot = realloc(q->slot, cap * sizeof(job_t *));
+    q->free_slots = realloc(q->free_slots, cap * sizeof(int));
+    if (!q->tree || !q->tickets || !q->slot || !q->free_slots) { perror("realloc"); exit(1); }
+    for (int i = q->cap; i < cap; i++) q->tickets[i] = 0;
+    q->cap = cap;
+
+    /* O(n) rebuild: each node passes its sum up to its parent */
+    for (int i = 1; i <= cap; i++) q->tree[i] = q->tickets[i - 1];
+    for (int i = 1; i <= cap; i++) {
+        int parent = i + (i & -i);
+        if (parent <= cap) q->tree[parent] += q->tree[i];
+    }
+}
+
+static long long tickets_of(const lottery_t *q, const job_t *j) {
+    int p = j->priority < 0 ? 0 : j->priority;
+    long long n = q->base / (p + 1);
+    return n < 1 ? 1 : n;
+}
+
+static void hold(lottery_t *q, job_t *j) {
+    int i;
+    if (q->nfree) {
+        i = q->free_slots[--q->nfree];
+    } else {
+        if (q->used == q->cap) grow(q);
+        i = q->used++;
+    }
+    long long n = tickets_of(q, j);
+    q->slot[i] = j;
+    q->tickets[i] = n;
+    fenwick_add(q, i, n);
+    SET_SLOT(j, i);
+}
+
+static void release(lottery_t *q, job_t *j) {
+    int i = SLOT(j);
+    fenwick_add(q, i, -q->tickets[i]);
+    q->tickets[i] = 0;
+    q->slot[i] = NULL;
+    q->free_slots[q->nfree++] = i;
+    SET_SLOT(j, -1);
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void lottery_push(void *self, job_t *j, int t) {
+    hold(self, j);
+}
+
+static job_t *lottery_draw(lottery_t *q) {
+    if (q->total == 0) return NULL;
+    job_t *j = q->slot[fenwick_find(q, (long long)(xorshift64s(&q->rng) % (uint64_t)q->total))];
+    release(q, j);
+    return j;
+}
+
+static job_t *lottery_pick_next(void *self, int t) {
+    lottery_t *q = self;
+    q->ran = 0;
+    if (q->winner) {
+        job_t *j = q->winner;
+        q->winner = NULL;
+        return j;
+    }
+    return lottery_draw(q);
+}
+
+/* End of quantum: draw over the queued tickets plus the running job's,
+   which sit past the end of the tree. Only another winner preempts. */
+static int lottery_on_tick(void *self, job_t *cur, int ticks, int t) {
+    lottery_t *q = self;
+    q->ran += ticks;
+    if (q->ran < q->quantum || q->total == 0 || cur->remaining <= 0) return 0;
+    long long r = (long long)(xorshift64s(&q->rng) % (uint64_t)(q->total + tickets_of(q, cur)));
+    if (r >= q->total) {
+        q->ran = 0;
+        return 0;
+    }
+    q->winner = q->slot[fenwick_find(q, r)];
+    release(q, q->winner);
+    return 1;
+}
+
+static void lottery_on_finish(void *self, job_t *j, int queued, int t) {
+    lottery_t *q = self;
+    if (j == q->winner) q->winner = NULL;
+    else if (queued) release(q, j);
+    j->policy_data = NULL;
+}
+
+/* The idle core's job is drawn by lottery too */
+static job_t *lottery_steal(void *self) {
+    return lottery_draw(self);
+}
+
+const sched_policy_t lottery_policy = {
+    SCHED_POLICY_API, "lottery",
+    lottery_init, lottery_fini,
+    lottery_push, lottery_pick_next, lottery_on_tick, lottery_push, lottery_on_finish,
+    lottery_steal,
+    NULL, NULL,
+};
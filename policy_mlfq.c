@@ -0,0 +1,184 @@
+/* policy_mlfq.c
+   Built-in multilevel feedback queue (--policy mlfq).
+
+   One FIFO per level, level 0 most urgent. A bitmap of non-empty levels
+   makes picking O(1): the lowest set bit is the level to serve. A job
+   starts at the level given by its CSV priority, gets a quantum of
+   q0 << level ticks there (capped at INT_MAX), and drops one level each
+   time it uses the whole quantum. A newly runnable job on a more urgent level preempts the
+   running one. Every `boost` ticks all jobs go back to level 0 so long
+   batch jobs are not starved.
+
+   --policy-opt keys: levels=N (default 4, max 32), q0=N (default 1),
+   boost=N (default 50, 0 = never).
+
+   The boost is O(levels): the per-level lists are spliced onto level 0
+   and each job's own level is brought up to date lazily the next time
+   the policy touches it. The epoch is derived from t, so every core agrees
+   on it and a job stolen from a core that has not yet seen the boost is
+   still handled correctly.
+*/
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+#define MLFQ_MAX_LEVELS 32
+
+typedef struct {
+    int level;
+    long long used;     /* ticks of the current quantum consumed */
+    int epoch;          /* boost epoch `level` is valid for */
+} mlfq_job_t;
+
+typedef struct {
+    job_t *head[MLFQ_MAX_LEVELS], *tail[MLFQ_MAX_LEVELS];
+    unsigned int nonempty;      /* bit L set <=> level L has jobs */
+    int levels, q0, boost;
+    int epoch;
+} mlfq_t;
+
+static void *mlfq_init(int cpu, int ncpus, const char *opts) {
+    mlfq_t *q = calloc(1, sizeof(mlfq_t));
+    if (!q) return NULL;
+    q->levels = policy_opt_int(opts, "levels", 4);
+    q->q0 = policy_opt_int(opts, "q0", 1);
+    q->boost = policy_opt_int(opts, "boost", 50);
+    if (q->levels < 1 || q->levels > MLFQ_MAX_LEVELS || q->q0 < 1 || q->boost < 0) {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+
+static void mlfq_fini(void *self) {
+    free(self);
+}
+
+/* ---------------- LEVEL QUEUES ---------------- */
+
+static void level_push(mlfq_t *q, int l, job_t *j) {
+    j->next = NULL;
+    j->prev = q->tail[l];
+    if (q->tail[l]) q->tail[l]->next = j;
+    else q->head[l] = j;
+    q->tail[l] = j;
+    q->nonempty |= 1u << l;
+}
+
+static void level_remove(mlfq_t *q, int l, job_t *j) {
+    if (j->prev) j->prev->next = j->next;
+    else q->head[l] = j->next;
+    if (j->next) j->next->prev = j->prev;
+    else q->tail[l] = j->prev;
+    j->next = j->prev = NULL;
+    if (!q->head[l]) q->nonempty &= ~(1u << l);
+}
+
+/* Priority boost: splice every level onto the end of level 0 */
+static void mlfq_advance(mlfq_t *q, int t) {
+    if (q->boost == 0) return;
+    int epoch = t / q->boost;
+    if (epoch == q->epoch) return;
+    q->epoch = epoch;
+    for (int l = 1; l < q->levels; l++) {
+        if (!q->head[l]) continue;
+        if (q->tail[0]) {
+            q->tail[0]->next = q->head[l];
+            q->head[l]->prev = q->tail[0];
+        } else {
+            q->head[0] = q->head[l];
+        }
+        q->tail[0] = q->tail[l];
+        q->head[l] = q->tail[l] = NULL;
+    }
+    if (q->nonempty) q->nonempty = 1;
+}
+
+/* The job's bookkeeping, brought up to date with any boost it missed */
+static mlfq_job_t *job_info(mlfq_t *q, job_t *j) {
+    mlfq_job_t *m = j->policy_data;
+    if (m->epoch != q->epoch) {
+        m->level = 0;
+        m->used = 0;
+        m->epoch = q->epoch;
+    }
+    return m;
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void mlfq_on_arrival(void *self, job_t *j, int t) {
+    mlfq_t *q = self;
+    mlfq_advance(q, t);
+    mlfq_job_t *m = calloc(1, sizeof(mlfq_job_t));
+    if (!m) { perror("calloc"); exit(1); }
+    m->level = j->priority < 0 ? 0 : j->priority >= q->levels ? q->levels - 1 : j->priority;
+    m->epoch = q->epoch;
+    j->policy_data = m;
+    level_push(q, m->level, j);
+}
+
+static job_t *mlfq_pick_next(void *self, int t) {
+    mlfq_t *q = self;
+    mlfq_advance(q, t);
+    if (!q->nonempty) return NULL;
+    int l = __builtin_ctz(q->nonempty);
+    job_t *j = q->head[l];
+    level_remove(q, l, j);
+    return j;
+}
+
+/* q0 << level, saturated: levels= goes up to 32 and q0= is unbounded */
+static long long level_quantum(const mlfq_t *q, int level) {
+    long long quantum = (long long)q->q0 << level;
+    return quantum > INT_MAX ? INT_MAX : quantum;
+}
+
+static int mlfq_on_tick(void *self, job_t *cur, int ticks, int t) {
+    mlfq_t *q = self;
+    mlfq_advance(q, t);
+    mlfq_job_t *m = job_info(q, cur);
+    m->used += ticks;
+    if (m->used >= level_quantum(q, m->level)) {
+        if (m->level < q->levels - 1) m->level++;
+        m->used = 0;
+        return 1;
+    }
+    /* Something more urgent is waiting */
+    return (q->nonempty & ((1u << m->level) - 1)) != 0;
+}
+
+static void mlfq_on_preempt(void *self, job_t *j, int t) {
+    mlfq_t *q = self;
+    mlfq_advance(q, t);
+    level_push(q, job_info(q, j)->level, j);
+}
+
+static void mlfq_on_finish(void *self, job_t *j, int queued, int t) {
+    mlfq_t *q = self;
+    mlfq_advance(q, t);
+    if (queued) level_remove(q, job_info(q, j)->level, j);
+    free(j->policy_data);
+    j->policy_data = NULL;
+}
+
+/* Give away the job that would wait longest here: the tail of the least
+   urgent non-empty level */
+static job_t *mlfq_steal(void *self) {
+    mlfq_t *q = self;
+    if (!q->nonempty) return NULL;
+    int l = 31 - __builtin_clz(q->nonempty);
+    job_t *j = q->tail[l];
+    level_remove(q, l, j);
+    return j;
+}
+
+const sched_policy_t mlfq_policy = {
+    SCHED_POLICY_API, "mlfq",
+    mlfq_init, mlfq_fini,
+    mlfq_on_arrival, mlfq_pick_next, mlfq_on_tick, mlfq_on_preempt, mlfq_on_finish,
+    mlfq_steal,
+    NULL, NULL,
+};
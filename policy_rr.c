@@ -0,0 +1,162 @@
+/* policy_rr.c
+   Built-in Round-Robin (q=1) - the original Stallings Fig 9.5 dispatcher
+   behaviour. FIFO queue per core; the running job is preempted after every
+   tick whenever anything else is waiting. Stealing takes from the tail.
+
+   Adaptive mode (--policy-opt latency=N[,min_gran=M]): instead of q=1,
+   each dispatch gets quantum = max(min_gran, latency / runnable), where
+   runnable is the queue length (kept as a counter) plus the job being
+   dispatched. A few long jobs then keep the CPU for many ticks, and
+   thousands of jobs still each come round within about `latency` ticks.
+   Every change of quantum is logged with its tick and queue depth and
+   printed as a time series after the statistics.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+#define RR_SERIES_ROWS 40      /* time-series rows printed per core */
+
+typedef struct {
+    int t, depth, quantum;
+} rr_sample_t;
+
+typedef struct {
+    job_t *rr_head, *rr_tail;
+    int rr_len;
+    int cpu;
+    int latency, min_gran;      /* latency 0 = classic q=1 */
+    int quantum, ran;
+    rr_sample_t *series;
+    int series_len, series_cap;
+    long dispatches;
+    long long quantum_sum;
+} rr_t;
+
+static void *rr_init(int cpu, int ncpus, const char *opts) {
+    rr_t *q = calloc(1, sizeof(rr_t));
+    if (!q) return NULL;
+    q->cpu = cpu;
+    q->latency = policy_opt_int(opts, "latency", 0);
+    q->min_gran = policy_opt_int(opts, "min_gran", 1);
+    if (q->latency < 0 || q->min_gran < 1) {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+
+static void rr_fini(void *self) {
+    rr_t *q = self;
+    free(q->series);
+    free(q);
+}
+
+/* ---------------- QUEUE FUNCTIONS ---------------- */
+
+static void enqueue_rr(rr_t *q, job_t *j) {
+    j->next = NULL;
+    j->prev = q->rr_tail;
+    if (!q->rr_tail) q->rr_head = q->rr_tail = j;
+    else { q->rr_tail->next = j; q->rr_tail = j; }
+    q->rr_len++;
+}
+
+/* Unlink a job from anywhere in the queue */
+static void rr_remove(rr_t *q, job_t *j) {
+    if (j->prev) j->prev->next = j->next;
+    else q->rr_head = j->next;
+    if (j->next) j->next->prev = j->prev;
+    else q->rr_tail = j->prev;
+    j->next = j->prev = NULL;
+    q->rr_len--;
+}
+
+static job_t *dequeue_rr(rr_t *q) {
+    job_t *j = q->rr_head;
+    if (j) rr_remove(q, j);
+    return j;
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void rr_on_arrival(void *self, job_t *j, int t) {
+    enqueue_rr(self, j);
+}
+
+/* Adaptive mode: size the quantum for a dispatch from the queue depth */
+static void rr_set_quantum(rr_t *q, int t) {
+    int runnable = q->rr_len + 1;
+    int quantum = q->latency / runnable;
+    if (quantum < q->min_gran) quantum = q->min_gran;
+
+    if (q->series_len == 0 || q->series[q->series_len - 1].quantum != quantum) {
+        if (q->series_len == q->series_cap) {
+            q->series_cap = q->series_cap ? q->series_cap * 2 : 256;
+            q->series = realloc(q->series, q->series_cap * sizeof(rr_sample_t));
+            if (!q->series) { perror("realloc"); exit(1); }
+        }
+        q->series[q->series_len++] = (rr_sample_t){ t, runnable - 1, quantum };
+    }
+    q->quantum = quantum;
+    q->ran = 0;
+    q->dispatches++;
+    q->quantum_sum += quantum;
+}
+
+static job_t *rr_pick_next(void *self, int t) {
+    rr_t *q = self;
+    job_t *j = dequeue_rr(q);
+    if (j && q->latency) rr_set_quantum(q, t);
+    return j;
+}
+
+static int rr_on_tick(void *self, job_t *cur, int ticks, int t) {
+    rr_t *q = self;
+    if (!q->latency) return 1;  /* q = 1: give way after every tick */
+    q->ran += ticks;
+    return q->ran >= q->quantum;
+}
+
+static void rr_on_preempt(void *self, job_t *j, int t) {
+    enqueue_rr(self, j);
+}
+
+static void rr_on_finish(void *self, job_t *j, int queued, int t) {
+    if (queued) rr_remove(self, j);
+}
+
+static job_t *rr_steal(void *self) {
+    rr_t *q = self;
+    job_t *j = q->rr_tail;
+    if (j) rr_remove(q, j);
+    return j;
+}
+
+/* Adaptive mode: the quantum time series, thinned to RR_SERIES_ROWS */
+static void rr_report(void **selves, int n) {
+    for (int i = 0; i < n; i++) {
+        rr_t *q = selves[i];
+        if (!q->latency || !q->dispatches) continue;
+        char tag[16] = "";
+        if (n > 1) snprintf(tag, sizeof(tag), " on CPU%d", q->cpu);
+        printf("\nAdaptive quantum%s (latency %d, min_gran %d): %ld dispatches, mean %.2f ticks\n",
+               tag, q->latency, q->min_gran, q->dispatches, (double)q->quantum_sum / q->dispatches);
+        printf("   Tick   | Queue depth | Quantum\n");
+        printf("----------+-------------+---------\n");
+        int step = q->series_len > RR_SERIES_ROWS ? q->series_len / RR_SERIES_ROWS : 1;
+        for (int k = 0; k < q->series_len; k += step)
+            printf(" %-8d | %-11d | %d\n", q->series[k].t, q->series[k].depth, q->series[k].quantum);
+        if (step > 1)
+            printf(" (%d changes, every %dth shown)\n", q->series_len, step);
+    }
+}
+
+const sched_policy_t rr_policy = {
+    SCHED_POLICY_API, "rr",
+    rr_init, rr_fini,
+    rr_on_arrival, rr_pick_next, rr_on_tick, rr_on_preempt, rr_on_finish,
+    rr_steal,
+    NULL, rr_report,
+};
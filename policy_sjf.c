@@ -0,0 +1,270 @@
+/* policy_sjf.c
+   Built-in shortest-job-first (--policy sjf) and its preemptive form,
+   shortest-remaining-time-first (--policy srtf), for traces whose bursts
+   are not known in advance.
+
+   Neither policy looks at a job's real burst. Each job-class (CSV column
+   11, 0 when absent) keeps an exponential average of the bursts its jobs
+   actually had: tau' = alpha * burst + (1 - alpha) * tau, starting at
+   `guess`. A job's predicted burst is its class's tau when it arrives.
+   Its predicted remaining time is its estimate minus the ticks it has run.
+   The estimate starts as the prediction; a job that runs past it is not
+   nearly done but mispredicted, so its estimate doubles until it is ahead
+   of the ticks run again. Runnable jobs sit in an indexed binary min-heap on that
+   key. Under srtf a queued job predicted to finish sooner preempts the
+   running one; under sjf a job runs to completion once picked. The
+   class table is shared by all cores, so every core learns from every
+   finished job.
+
+   The Pred. error statistics column is predicted - actual burst.
+
+   --policy-opt keys: alpha=N percent (default 50), guess=N ticks
+   (default 5).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+typedef struct {
+    job_t *job;
+    int heap_pos;
+    double predicted;       /* burst predicted at arrival */
+    double estimate;        /* predicted, doubled each time it is overrun */
+    int ran;
+} sjf_job_t;
+
+typedef struct {
+    sjf_job_t **heap;
+    int len, cap;
+    int preemptive;
+    double alpha, guess;
+    int finished;
+    double abs_err_sum;
+} sjf_t;
+
+/* ---------------- CLASS PREDICTOR ---------------- */
+
+/* Open-addressing map class -> exponential average, shared by cores */
+typedef struct {
+    int cls;
+    int used;
+    double tau;
+} class_slot_t;
+
+static class_slot_t *classes;
+static int class_cap, class_count, class_users;
+
+static class_slot_t *class_find(int cls) {
+    unsigned int h = (unsigned int)cls * 2654435761u;
+    for (int i = h & (class_cap - 1); ; i = (i + 1) & (class_cap - 1))
+        if (!classes[i].used || classes[i].cls == cls) return &classes[i];
+}
+
+static void class_grow() {
+    class_slot_t *old = classes;
+    int old_cap = class_cap;
+    class_cap = class_cap ? class_cap * 2 : 64;
+    classes = calloc(class_cap, sizeof(class_slot_t));
+    if (!classes) { perror("calloc"); exit(1); }
+    for (int i = 0; i < old_cap; i++)
+        if (old[i].used) *class_find(old[i].cls) = old[i];
+    free(old);
+}
+
+static double class_predict(sjf_t *q, int cls) {
+    class_slot_t *s = class_find(cls);
+    return s->used ? s->tau : q->guess;
+}
+
+static void class_learn(sjf_t *q, int cls, int burst) {
+    if ((class_count + 1) * 2 > class_cap) class_grow();
+    class_slot_t *s = class_find(cls);
+    if (!s->used) {
+        s->used = 1;
+        s->cls = cls;
+        s->tau = q->guess;
+        class_count++;
+    }
+    s->tau = q->alpha * burst + (1 - q->alpha) * s->tau;
+}
+
+/* ---------------- INIT ---------------- */
+
+static void *sjf_create(const char *opts, int preemptive) {
+    sjf_t *q = calloc(1, sizeof(sjf_t));
+    if (!q) return NULL;
+    int alpha = policy_opt_int(opts, "alpha", 50);
+    int guess = policy_opt_int(opts, "guess", 5);
+    if (alpha < 0 || alpha > 100 || guess < 1) {
+        free(q);
+        return NULL;
+    }
+    q->alpha = alpha / 100.0;
+    q->guess = guess;
+    q->preemptive = preemptive;
+    if (!class_users++) class_grow();
+    return q;
+}
+
+static void *sjf_init(int cpu, int ncpus, const char *opts) {
+    return sjf_create(opts, 0);
+}
+
+static void *srtf_init(int cpu, int ncpus, const char *opts) {
+    return sjf_create(opts, 1);
+}
+
+static void sjf_fini(void *self) {
+    sjf_t *q = self;
+    free(q->heap);
+    free(q);
+    if (!--class_users) {
+        free(classes);
+        classes = NULL;
+        class_cap = class_count = 0;
+    }
+}
+
+/* ---------------- REMAINING-TIME MIN-HEAP ---------------- */
+
+static double predicted_remaining(const sjf_job_t *s) {
+    return s->estimate - s->ran;
+}
+
+static int shorter(const sjf_job_t *a, const sjf_job_t *b) {
+    double ra = predicted_remaining(a), rb = predicted_remaining(b);
+    if (ra != rb) return ra < rb;
+    return a->job->idx < b->job->idx;
+}
+
+static void heap_place(sjf_t *q, int i, sjf_job_t *s) {
+    q->heap[i] = s;
+    s->heap_pos = i;
+}
+
+static void sift_up(sjf_t *q, int i) {
+    sjf_job_t *s = q->heap[i];
+    while (i > 0 && shorter(s, q->heap[(i - 1) / 2])) {
+        heap_place(q, i, q->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    heap_place(q, i, s);
+}
+
+static void sift_down(sjf_t *q, int i) {
+    sjf_job_t *s = q->heap[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= q->len) break;
+        if (c + 1 < q->len && shorter(q->heap[c + 1], q->heap[c])) c++;
+        if (!shorter(q->heap[c], s)) break;
+        heap_place(q, i, q->heap[c]);
+        i = c;
+    }
+    heap_place(q, i, s);
+}
+
+static void heap_push(sjf_t *q, sjf_job_t *s) {
+    if (q->len == q->cap) {
+        q->cap = q->cap ? q->cap * 2 : 64;
+        q->heap = realloc(q->heap, q->cap * sizeof(sjf_job_t *));
+        if (!q->heap) { perror("realloc"); exit(1); }
+    }
+    heap_place(q, q->len++, s);
+    sift_up(q, q->len - 1);
+}
+
+static void heap_remove(sjf_t *q, sjf_job_t *s) {
+    int i = s->heap_pos;
+    sjf_job_t *moved = q->heap[--q->len];
+    if (i < q->len) {
+        heap_place(q, i, moved);
+        if (i > 0 && shorter(moved, q->heap[(i - 1) / 2])) sift_up(q, i);
+        else sift_down(q, i);
+    }
+    s->heap_pos = -1;
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void sjf_on_arrival(void *self, job_t *j, int t) {
+    sjf_t *q = self;
+    sjf_job_t *s = calloc(1, sizeof(sjf_job_t));
+    if (!s) { perror("calloc"); exit(1); }
+    s->job = j;
+    s->predicted = class_predict(q, j->job_class);
+    s->estimate = s->predicted < 1 ? 1 : s->predicted;
+    j->policy_data = s;
+    heap_push(q, s);
+}
+
+static job_t *sjf_pick_next(void *self, int t) {
+    sjf_t *q = self;
+    if (q->len == 0) return NULL;
+    sjf_job_t *s = q->heap[0];
+    heap_remove(q, s);
+    return s->job;
+}
+
+static int sjf_on_tick(void *self, job_t *cur, int ticks, int t) {
+    sjf_t *q = self;
+    sjf_job_t *s = cur->policy_data;
+    s->ran += ticks;
+    while (s->estimate <= s->ran) s->estimate *= 2;
+    return q->preemptive && q->len > 0 && shorter(q->heap[0], s);
+}
+
+static void sjf_on_preempt(void *self, job_t *j, int t) {
+    heap_push(self, j->policy_data);
+}
+
+static void sjf_on_finish(void *self, job_t *j, int queued, int t) {
+    sjf_t *q = self;
+    sjf_job_t *s = j->policy_data;
+    if (queued) heap_remove(q, s);
+
+    /* A crashed job never showed its real burst: nothing to learn */
+    if (j->remaining <= 0) {
+        double err = s->predicted - j->total_cpu;
+        class_learn(q, j->job_class, j->total_cpu);
+        q->finished++;
+        q->abs_err_sum += err < 0 ? -err : err;
+        j->stat = err;
+    }
+    free(s);
+    j->policy_data = NULL;
+}
+
+static job_t *sjf_steal(void *self) {
+    return sjf_pick_next(self, 0);
+}
+
+static void sjf_report(void **selves, int n) {
+    int finished = 0;
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        sjf_t *q = selves[i];
+        finished += q->finished;
+        sum += q->abs_err_sum;
+    }
+    if (finished)
+        printf("Burst prediction: mean |error| %.2f ticks over %d jobs, %d classes\n",
+               sum / finished, finished, class_count);
+}
+
+const sched_policy_t sjf_policy = {
+    SCHED_POLICY_API, "sjf",
+    sjf_init, sjf_fini,
+    sjf_on_arrival, sjf_pick_next, sjf_on_tick, sjf_on_preempt, sjf_on_finish,
+    sjf_steal,
+    "Pred. error", sjf_report,
+};
+
+const sched_policy_t srtf_policy = {
+    SCHED_POLICY_API, "srtf",
+    srtf_init, sjf_fini,
+    sjf_on_arrival, sjf_pick_next, sjf_on_tick, sjf_on_preempt, sjf_on_finish,
+    sjf_steal,
+    "Pred. error", sjf_report,
+};
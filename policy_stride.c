@@ -0,0 +1,265 @@
+/* policy_stride.c
+   Built-in stride scheduling (--policy stride), after Waldspurger & Weihl.
+
+   The deterministic counterpart of --policy lottery. Each job holds
+   tickets = base / (priority + 1) and has stride = STRIDE1 / tickets. The
+   runnable job with the smallest pass runs next (binary min-heap, O(log n))
+   and its pass grows by its stride for every tick it gets.
+
+   Each core keeps a global pass that grows at STRIDE1 / total tickets per
+   tick. A job that joins mid-run starts at global_pass + stride, so it
+   gains no credit for time it was not runnable. A job stolen by another
+   core takes its distance from the victim's global pass with it.
+
+   Accuracy is judged the way the stride paper does it: the absolute error
+   between the CPU a job received and what its tickets entitled it to
+   while it was runnable. The error falls while a job waits and rises while
+   it runs, so its extremes are sampled when the job is dispatched and when
+   it stops. The per-job maximum is the Max error statistics column.
+
+   --policy-opt keys: base=N (default 100), quantum=N ticks (default 1).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "policy.h"
+
+#define STRIDE1 (1ULL << 20)
+
+typedef struct {
+    job_t *job;
+    int heap_pos;
+    long long tickets;
+    unsigned long long stride, pass;
+    int migrating;          /* pass holds the distance from global pass */
+    double ent_base;        /* core's integral when it joined */
+    double entitled;        /* owed on cores it already left */
+    double max_err;
+} stride_job_t;
+
+typedef struct {
+    stride_job_t **heap;
+    int len, cap;
+    long long tickets;      /* runnable tickets on this core */
+    unsigned long long global_pass;
+    double ent;             /* integral of 1 / tickets over time */
+    int last_t, now;
+    int base, quantum;
+    int ran;
+    /* over finished jobs */
+    int finished;
+    double err_sum, err_max;
+    int err_max_id;
+} stride_t;
+
+static void *stride_init(int cpu, int ncpus, const char *opts) {
+    stride_t *q = calloc(1, sizeof(stride_t));
+    if (!q) return NULL;
+    q->base = policy_opt_int(opts, "base", 100);
+    q->quantum = policy_opt_int(opts, "quantum", 1);
+    if (q->base < 1 || q->quantum < 1) {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+
+static void stride_fini(void *self) {
+    stride_t *q = self;
+    free(q->heap);
+    free(q);
+}
+
+/* ---------------- PASS MIN-HEAP ---------------- */
+
+static int pass_before(const stride_job_t *a, const stride_job_t *b) {
+    if (a->pass != b->pass) return a->pass < b->pass;
+    return a->job->idx < b->job->idx;
+}
+
+static void heap_place(stride_t *q, int i, stride_job_t *s) {
+    q->heap[i] = s;
+    s->heap_pos = i;
+}
+
+static void sift_up(stride_t *q, int i) {
+    stride_job_t *s = q->heap[i];
+    while (i > 0 && pass_before(s, q->heap[(i - 1) / 2])) {
+        heap_place(q, i, q->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    heap_place(q, i, s);
+}
+
+static void sift_down(stride_t *q, int i) {
+    stride_job_t *s = q->heap[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= q->len) break;
+        if (c + 1 < q->len && pass_before(q->heap[c + 1], q->heap[c])) c++;
+        if (!pass_before(q->heap[c], s)) break;
+        heap_place(q, i, q->heap[c]);
+        i = c;
+    }
+    heap_place(q, i, s);
+}
+
+static void heap_push(stride_t *q, stride_job_t *s) {
+    if (q->len == q->cap) {
+        q->cap = q->cap ? q->cap * 2 : 64;
+        q->heap = realloc(q->heap, q->cap * sizeof(stride_job_t *));
+        if (!q->heap) { perror("realloc"); exit(1); }
+    }
+    heap_place(q, q->len++, s);
+    sift_up(q, q->len - 1);
+}
+
+static void heap_remove(stride_t *q, stride_job_t *s) {
+    int i = s->heap_pos;
+    stride_job_t *moved = q->heap[--q->len];
+    if (i < q->len) {
+        heap_place(q, i, moved);
+        if (i > 0 && pass_before(moved, q->heap[(i - 1) / 2])) sift_up(q, i);
+        else sift_down(q, i);
+    }
+    s->heap_pos = -1;
+}
+
+/* ---------------- ACCOUNTING ---------------- */
+
+/* Move the global pass and the entitlement integral up to time t at the
+   current ticket total. Must run before the runnable set changes. */
+static void advance(stride_t *q, int t) {
+    if (t > q->now) q->now = t;
+    if (t <= q->last_t) return;
+    if (q->tickets > 0) {
+        q->global_pass += (t - q->last_t) * (STRIDE1 / q->tickets);
+        q->ent += (double)(t - q->last_t) / q->tickets;
+    }
+    q->last_t = t;
+}
+
+static void sample_error(stride_t *q, stride_job_t *s) {
+    double entitled = s->entitled + s->tickets * (q->ent - s->ent_base);
+    double err = (s->job->total_cpu - s->job->remaining) - entitled;
+    if (err < 0) err = -err;
+    if (err > s->max_err) s->max_err = err;
+}
+
+static void join(stride_t *q, stride_job_t *s, unsigned long long remain, int t) {
+    advance(q, t);
+    s->pass = q->global_pass + remain;
+    s->ent_base = q->ent;
+    q->tickets += s->tickets;
+}
+
+/* Returns how far ahead of the global pass the job was */
+static unsigned long long leave(stride_t *q, stride_job_t *s, int t) {
+    advance(q, t);
+    sample_error(q, s);
+    s->entitled += s->tickets * (q->ent - s->ent_base);
+    q->tickets -= s->tickets;
+    return s->pass > q->global_pass ? s->pass - q->global_pass : 0;
+}
+
+/* ---------------- POLICY HOOKS ---------------- */
+
+static void stride_on_arrival(void *self, job_t *j, int t) {
+    stride_t *q = self;
+    stride_job_t *s = calloc(1, sizeof(stride_job_t));
+    if (!s) { perror("calloc"); exit(1); }
+    int p = j->priority < 0 ? 0 : j->priority;
+    s->job = j;
+    s->tickets = q->base / (p + 1);
+    if (s->tickets < 1) s->tickets = 1;
+    s->stride = STRIDE1 / s->tickets;
+    j->policy_data = s;
+    join(q, s, s->stride, t);
+    heap_push(q, s);
+}
+
+static job_t *stride_pick_next(void *self, int t) {
+    stride_t *q = self;
+    if (q->len == 0) return NULL;
+    stride_job_t *s = q->heap[0];
+    heap_remove(q, s);
+    advance(q, t);
+    sample_error(q, s);
+    q->ran = 0;
+    return s->job;
+}
+
+static int stride_on_tick(void *self, job_t *cur, int ticks, int t) {
+    stride_t *q = self;
+    stride_job_t *s = cur->policy_data;
+    advance(q, t);
+    s->pass += ticks * s->stride;
+    q->ran += ticks;
+    return q->ran >= q->quantum;
+}
+
+static void stride_on_preempt(void *self, job_t *j, int t) {
+    stride_t *q = self;
+    stride_job_t *s = j->policy_data;
+    if (s->migrating) {
+        s->migrating = 0;
+        join(q, s, s->pass, t);
+    } else {
+        advance(q, t);
+        sample_error(q, s);
+    }
+    heap_push(q, s);
+}
+
+static void stride_on_finish(void *self, job_t *j, int queued, int t) {
+    stride_t *q = self;
+    stride_job_t *s = j->policy_data;
+    if (queued) heap_remove(q, s);
+    leave(q, s, t);
+
+    q->finished++;
+    q->err_sum += s->max_err;
+    if (s->max_err > q->err_max || q->finished == 1) {
+        q->err_max = s->max_err;
+        q->err_max_id = j->id;
+    }
+    j->stat = s->max_err;
+    free(s);
+    j->policy_data = NULL;
+}
+
+/* Give away the job with the smallest pass: it is owed the most CPU */
+static job_t *stride_steal(void *self) {
+    stride_t *q = self;
+    if (q->len == 0) return NULL;
+    stride_job_t *s = q->heap[0];
+    heap_remove(q, s);
+    s->pass = leave(q, s, q->now);
+    s->migrating = 1;
+    return s->job;
+}
+
+static void stride_report(void **selves, int n) {
+    int finished = 0, max_id = -1;
+    double sum = 0, max = 0;
+    for (int i = 0; i < n; i++) {
+        stride_t *q = selves[i];
+        finished += q->finished;
+        sum += q->err_sum;
+        if (q->finished && (max_id < 0 || q->err_max > max)) {
+            max = q->err_max;
+            max_id = q->err_max_id;
+        }
+    }
+    if (!finished) return;
+    printf("Stride |received - entitled|: max %.2f ticks (Job %d), mean per-job max %.2f\n",
+           max, max_id, sum / finished);
+}
+
+const sched_policy_t stride_policy = {
+    SCHED_POLICY_API, "stride",
+    stride_init, stride_fini,
+    stride_on_arrival, stride_pick_next, stride_on_tick, stride_on_preempt, stride_on_finish,
+    stride_steal,
+    "Max error", stride_report,
+};